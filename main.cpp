@@ -11,6 +11,7 @@
 #include "placement/placement.hpp"
 #include "repair/repair.hpp"
 #include "memcached_client.hpp"
+#include "thread_pool.hpp"
 #include "block_manager.hpp"
 #include "gf256_solver/gf256_solver.hpp"
 
@@ -49,8 +50,10 @@ int main() {
     // 1) 生成原始数据块
     auto data_vec = generate_random_blocks(data_blocks, BLOCK_SIZE);
 
-    // 2) encoding 
+    // 2) encoding （工作窃取线程池，默认线程数 = CPU 核数）
+    ThreadPool encode_pool;
     Encoder encoder;
+    encoder.set_thread_pool(&encode_pool);
     auto encoded_map = encoder.encode(data_vec, k1, m1, k2, m2, BLOCK_SIZE);
     std::cout << "[INFO] Encoding done. Encoded blocks = "
               << encoded_map.size() << "\n";
@@ -78,6 +81,7 @@ int main() {
     // 6) 枚举故障组合（单/二/三块）并调用修复（这里假设 Repair 提供 enumerate_failures)
     Repair repair(k1, m1, k2, m2);
     repair.set_strategy(strategy);
+    repair.set_block_size(BLOCK_SIZE);
 
     // 简单：枚举单/二/三块组合的示例（完整枚举请用你的枚举工具）
     std::vector<std::vector<int>> failure_list;
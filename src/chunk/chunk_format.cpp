@@ -0,0 +1,44 @@
+#include "chunk_format.hpp"
+
+static void put_le(std::string& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back((char)((v >> (8 * i)) & 0xff));
+}
+
+static uint64_t get_le(const std::string& in, size_t pos, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) v |= (uint64_t)(uint8_t)in[pos + i] << (8 * i);
+    return v;
+}
+
+int ChunkHeader::chunk_count() const {
+    if (chunk_size == 0) return 0;
+    return (int)((block_size + chunk_size - 1) / chunk_size);
+}
+
+size_t ChunkHeader::chunk_length(int c) const {
+    size_t off = chunk_offset(c);
+    if (off >= block_size) return 0;
+    size_t rest = (size_t)block_size - off;
+    return rest < chunk_size ? rest : chunk_size;
+}
+
+std::string ChunkHeader::encode() const {
+    std::string out;
+    out.reserve(kEncodedSize);
+    put_le(out, kMagic, 4);
+    put_le(out, chunk_size, 4);
+    put_le(out, block_size, 8);
+    return out;
+}
+
+bool ChunkHeader::decode(const std::string& bytes, ChunkHeader& out) {
+    if (bytes.size() != kEncodedSize) return false;
+    if (get_le(bytes, 0, 4) != kMagic) return false;
+    out.chunk_size = (uint32_t)get_le(bytes, 4, 4);
+    out.block_size = get_le(bytes, 8, 8);
+    return out.chunk_size > 0;
+}
+
+std::string chunk_suffix(int c) {
+    return "#" + std::to_string(c);
+}
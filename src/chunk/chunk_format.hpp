@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 分块存储格式（chunked block）
+// 一个逻辑块不再是单个 memcached item，而是：
+//   block_key(id)      : 16 字节头  magic | chunk_size | block_size（小端）
+//   block_key(id)#<c>  : 第 c 个 chunk，长度 chunk_size（最后一个可能更短）
+// 块大小因此不受 server item 上限（默认 1MB）限制，编码 / 写入 / 读取 / 解码
+// 都可以按 chunk 流式进行。头最后写入：读到头即说明全部 chunk 已写完
+struct ChunkHeader {
+    static constexpr uint32_t kMagic = 0x4b484350;   // "PCHK"
+    static constexpr size_t kEncodedSize = 16;
+    static constexpr size_t kDefaultChunkSize = 256 * 1024;
+
+    uint64_t block_size = 0;
+    uint32_t chunk_size = 0;
+
+    int chunk_count() const;
+    size_t chunk_offset(int c) const { return (size_t)c * chunk_size; }
+    size_t chunk_length(int c) const;
+
+    std::string encode() const;
+    // 长度或 magic 不符时返回 false（例如读到的是未分块的旧格式块）
+    static bool decode(const std::string& bytes, ChunkHeader& out);
+};
+
+// 第 c 个 chunk 的 key 后缀，完整 key 为 Placement::block_key(id) + chunk_suffix(c)
+std::string chunk_suffix(int c);
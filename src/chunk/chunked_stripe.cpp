@@ -0,0 +1,110 @@
+#include "chunked_stripe.hpp"
+#include "encoder.hpp"
+#include "stripe_slab.hpp"
+#include "placement.hpp"
+#include "memcached_client.hpp"
+#include "io_executor.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+ChunkedStripeWriter::ChunkedStripeWriter(Encoder& encoder, Placement& placement,
+                                         MemcachedClient& client, size_t chunk_size)
+    : encoder_(encoder), placement_(placement), client_(client),
+      chunk_size_(chunk_size > 0 ? chunk_size : ChunkHeader::kDefaultChunkSize) {}
+
+int ChunkedStripeWriter::write(const std::vector<BlockView>& data_blocks,
+                               int k1, int m1, int k2, int m2,
+                               size_t block_size)
+{
+    ChunkHeader header;
+    header.block_size = block_size;
+    header.chunk_size = (uint32_t)chunk_size_;
+    const int chunks = header.chunk_count();
+    const int block_count = (k1 + m1) * (k2 + m2);
+
+    StripeSlab slabs[2];
+    PendingWrite pending[2];
+    std::vector<int> failed;   // 任一 chunk 写失败的块
+
+    for (int c = 0; c < chunks; ++c) {
+        size_t off = header.chunk_offset(c);
+        size_t len = header.chunk_length(c);
+
+        // 复用 slab 前先等它上一次（chunk c - 2）的写入完成
+        PendingWrite& slot = pending[c % 2];
+        if (slot.done) placement_.wait_writes(slot, &failed);
+
+        std::vector<BlockView> slice(data_blocks.size());
+        for (size_t i = 0; i < data_blocks.size(); ++i) {
+            const BlockView& d = data_blocks[i];
+            if (d.data && d.len > off) slice[i] = BlockView{d.data + off, std::min(len, d.len - off)};
+        }
+        std::vector<BlockView> views = encoder_.encode(slice, k1, m1, k2, m2, (int)len, slabs[c % 2]);
+        slot = placement_.write_views_async(views, chunk_suffix(c), client_);
+    }
+    for (PendingWrite& slot : pending) {
+        if (slot.done) placement_.wait_writes(slot, &failed);
+    }
+
+    // 头最后写，只写给全部 chunk 都成功的块
+    std::unordered_set<int> bad(failed.begin(), failed.end());
+    const std::string header_bytes = header.encode();
+    std::vector<BlockView> headers(block_count);
+    for (int id = 0; id < block_count; ++id) {
+        if (bad.count(id)) continue;
+        headers[id] = BlockView{reinterpret_cast<const uint8_t*>(header_bytes.data()),
+                                header_bytes.size()};
+    }
+    PendingWrite w = placement_.write_views_async(headers, "", client_);
+    int success = placement_.wait_writes(w);
+
+    std::cout << "[Chunked] Wrote " << success << " / " << block_count << " blocks in "
+              << chunks << " chunks of " << chunk_size_ << " bytes.\n";
+    return success;
+}
+
+bool read_chunked_block(MemcachedClient& client, const Placement& placement, int block_id,
+                        const std::function<bool(size_t, const uint8_t*, size_t)>& consume)
+{
+    const PlacementEntry& entry = placement.get(block_id);
+    const std::string ip = placement.server_ip(entry);
+    const int port = placement.server_port(entry);
+    const std::string base = placement.block_key(block_id);
+
+    std::string raw;
+    ChunkHeader header;
+    if (!client.get(ip, port, base, raw) || !ChunkHeader::decode(raw, header)) {
+        std::cerr << "[Chunked] Missing or invalid header for " << base << std::endl;
+        return false;
+    }
+
+    // 一次只有下一个 chunk 在途：处理 chunk c 时 chunk c + 1 已在读取
+    typedef std::pair<bool, std::string> ChunkResult;
+    CompletionQueue<ChunkResult> done;
+    auto request = [&](int c) {
+        IoExecutor::shared().submit(done, [&client, ip, port, key = base + chunk_suffix(c)]() {
+            ChunkResult r;
+            r.first = client.get(ip, port, key, r.second);
+            return r;
+        });
+    };
+
+    const int chunks = header.chunk_count();
+    if (chunks > 0) request(0);
+    for (int c = 0; c < chunks; ++c) {
+        ChunkResult r = done.pop();
+        if (c + 1 < chunks) request(c + 1);
+        bool ok = r.first && r.second.size() == header.chunk_length(c) &&
+                  consume(header.chunk_offset(c),
+                          reinterpret_cast<const uint8_t*>(r.second.data()), r.second.size());
+        if (!ok) {
+            // 等已发出的预取结束，done 才能安全析构
+            if (c + 1 < chunks) done.pop();
+            return false;
+        }
+    }
+    return true;
+}
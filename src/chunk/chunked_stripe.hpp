@@ -0,0 +1,45 @@
+#pragma once
+
+#include "chunk_format.hpp"
+#include "block_view.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class Encoder;
+class Placement;
+class MemcachedClient;
+
+// ---------------------------------------------------------
+// 分块流式编码 + 写入
+//
+// 编码是逐字节位置独立的线性运算，所以条带可以按 chunk 宽度切片：每次只把
+// 所有数据块的 [off, off + chunk) 交给 Encoder，得到该切片上全部校验块。
+// 两个 StripeSlab 交替使用：chunk c 异步写出的同时编码 chunk c + 1，
+// 内存占用约为 2 x 网格块数 x chunk_size，与块大小无关
+// ---------------------------------------------------------
+class ChunkedStripeWriter {
+public:
+    ChunkedStripeWriter(Encoder& encoder, Placement& placement, MemcachedClient& client,
+                        size_t chunk_size = ChunkHeader::kDefaultChunkSize);
+
+    // data_blocks: k1 * k2 个数据块（原地引用，短于 block_size 的补零）
+    // 返回完整写入（全部 chunk 与头）的块数
+    int write(const std::vector<BlockView>& data_blocks,
+              int k1, int m1, int k2, int m2,
+              size_t block_size);
+
+private:
+    Encoder& encoder_;
+    Placement& placement_;
+    MemcachedClient& client_;
+    size_t chunk_size_;
+};
+
+// 读取一个分块存储的块：先读头，然后按顺序把每个 chunk 交给
+// consume(offset, data, len)；处理 chunk c 时 chunk c + 1 已在读取中。
+// consume 返回 false 时提前结束（返回 false）
+bool read_chunked_block(MemcachedClient& client, const Placement& placement, int block_id,
+                        const std::function<bool(size_t, const uint8_t*, size_t)>& consume);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Lightweight, non-owning view of one encoded block (pointer + length).
+// The bytes are owned by whoever produced the view (e.g. a StripeSlab);
+// the view is only valid while that owner is alive and not reset.
+struct BlockView {
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+};
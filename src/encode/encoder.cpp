@@ -1,188 +1,363 @@
 #include "encoder.hpp"
 
-#include <jerasure.h>
-#include <jerasure/reed_sol.h>
-
 #include "gf256_solver.hpp"
+#include "gf256_region.hpp"
+#include "coding_matrix.hpp"
 
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <algorithm>
 #include <iostream>
 
 // reshape_data:
 // Input: data_blocks vector length == k1 * k2
-// D[r][c] -> r in [0..k2-1], c in [0..k1-1]
-// Each D[r][c] is block_size bytes (zero-padded if input shorter)
-void Encoder::reshape_data(const std::vector<std::string>& data_blocks,
-                           std::vector<std::vector<std::vector<uint8_t>>>& D,
-                           int k1, int k2, int block_size) {
+// D[r][c] -> r in [0..k2-1], c in [0..k1-1], stored at slab.block(r, c)
+// Each D[r][c] is block_size bytes (zero-padded if input shorter; slab is zeroed by reset)
+void Encoder::reshape_data(const std::vector<std::string>& data_blocks, StripeSlab& slab) {
+    int k1 = slab.k1(), k2 = slab.k2();
     assert((int)data_blocks.size() == k1 * k2);
-    D.assign(k2, std::vector<std::vector<uint8_t>>(k1, std::vector<uint8_t>(block_size, 0)));
 
     for (int r = 0; r < k2; ++r) {
         for (int c = 0; c < k1; ++c) {
             int idx = r * k1 + c;
             const std::string& s = data_blocks[idx];
-            size_t copy_len = std::min<size_t>(s.size(), (size_t)block_size);
+            size_t copy_len = std::min<size_t>(s.size(), (size_t)slab.block_size());
             if (copy_len > 0) {
-                memcpy(D[r][c].data(), s.data(), copy_len);
+                memcpy(slab.block(r, c), s.data(), copy_len);
             }
             // rest already zero
         }
     }
 }
 
-// generate_row_parity:
-// Use Reed-Sol Vandermonde coefficients for row parity:
-// Build a (m1+1) x k1 matrix with reed_sol_vandermonde_coding_matrix(k1, m1+1, 8)
-// and use rows 1..m1 as parity rows (consistent with prior Jerasure usage)
-void Encoder::generate_row_parity(const std::vector<std::vector<std::vector<uint8_t>>>& D,
-                                  std::vector<std::vector<std::vector<uint8_t>>>& R,
-                                  int k1, int m1, int k2, int block_size) {
-    R.assign(k2, std::vector<std::vector<uint8_t>>(m1, std::vector<uint8_t>(block_size, 0)));
-
-    if (m1 == 0) return;
-
-    int *vand_row = reed_sol_vandermonde_coding_matrix(k1, m1 + 1, 8); // (m1+1) * k1
-    // use rows 1..m1 (skip row 0 which would be all-ones)
-    for (int r = 0; r < k2; ++r) {
-        for (int p = 0; p < m1; ++p) {
-            for (int c = 0; c < k1; ++c) {
-                int idx = (p + 1) * k1 + c; // row (p+1) in vandermonde
-                uint8_t coef = static_cast<uint8_t>(vand_row[idx] & 0xFF);
-                for (int b = 0; b < block_size; ++b) {
-                    R[r][p][b] ^= gf256_mul(coef, D[r][c][b]);
-                }
-            }
+// row_parity_line:
+// R[r][p][off..off+len) ^= sum_c row_mat.coef(p, c) * D[r][c][off..off+len), for every p
+// row_mat is RS(k1, m1) from the registry: rows 1..m1 of
+// reed_sol_vandermonde_coding_matrix(k1, m1+1, 8) (row 0 would be all-ones)
+void Encoder::row_parity_line(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                              const CodingMatrix& row_mat, int r, size_t off, size_t len) const {
+    int k1 = slab.k1(), m1 = slab.m1();
+
+    for (int p = 0; p < m1; ++p) {
+        uint8_t* dst = slab.block(r, k1 + p) + off;
+        for (int c = 0; c < k1; ++c) {
+            gf256_region_mul_xor_tbl(dst, blocks[r * slab.cols() + c].data + off,
+                                     row_mat.table(p, c), len);
         }
     }
-    delete[] vand_row;
 }
 
-// generate_col_parity_for_data:
-// For data columns only: use reed_sol_vandermonde_coding_matrix(k2, m2+1, 8)
-// use rows 1..m2 as parity rows to produce C[q][c] for q in 0..m2-1, c in 0..k1-1
-void Encoder::generate_col_parity_for_data(const std::vector<std::vector<std::vector<uint8_t>>>& D,
-                                           std::vector<std::vector<std::vector<uint8_t>>>& C,
-                                           int k1, int k2, int m2, int block_size) {
-    C.assign(m2, std::vector<std::vector<uint8_t>>(k1, std::vector<uint8_t>(block_size, 0)));
+// col_parity_line:
+// C[q][c][off..off+len) ^= sum_r col_mat.coef(q, r) * D[r][c][off..off+len), for every q
+void Encoder::col_parity_line(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                              const CodingMatrix& col_mat, int c, size_t off, size_t len) const {
+    int k2 = slab.k2(), m2 = slab.m2();
 
-    if (m2 == 0) return;
+    for (int q = 0; q < m2; ++q) {
+        uint8_t* dst = slab.block(k2 + q, c) + off;
+        for (int r = 0; r < k2; ++r) {
+            gf256_region_mul_xor_tbl(dst, blocks[r * slab.cols() + c].data + off,
+                                     col_mat.table(q, r), len);
+        }
+    }
+}
+
+// cross_parity_line:
+// S[q][p][off..off+len) ^= sum_r col_mat.coef(q, r) * R[r][p][off..off+len), for every q
+void Encoder::cross_parity_line(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                                const CodingMatrix& col_mat, int p, size_t off, size_t len) const {
+    int k1 = slab.k1(), k2 = slab.k2(), m2 = slab.m2();
 
-    int *vand_col = reed_sol_vandermonde_coding_matrix(k2, m2 + 1, 8); // (m2+1) * k2
     for (int q = 0; q < m2; ++q) {
-        for (int c = 0; c < k1; ++c) {
-            for (int r = 0; r < k2; ++r) {
-                int idx = (q + 1) * k2 + r; // row (q+1)
-                uint8_t coef = static_cast<uint8_t>(vand_col[idx] & 0xFF);
-                for (int b = 0; b < block_size; ++b) {
-                    C[q][c][b] ^= gf256_mul(coef, D[r][c][b]);
-                }
-            }
+        uint8_t* dst = slab.block(k2 + q, k1 + p) + off;
+        for (int r = 0; r < k2; ++r) {
+            gf256_region_mul_xor_tbl(dst, blocks[r * slab.cols() + k1 + p].data + off,
+                                     col_mat.table(q, r), len);
         }
     }
-    delete[] vand_col;
+}
+
+// *_range: the same kernels over every row / data column / parity column
+void Encoder::row_parity_range(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                               const CodingMatrix& row_mat, size_t off, size_t len) const {
+    for (int r = 0; r < slab.k2(); ++r)
+        row_parity_line(blocks, slab, row_mat, r, off, len);
+}
+
+void Encoder::col_parity_range(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                               const CodingMatrix& col_mat, size_t off, size_t len) const {
+    for (int c = 0; c < slab.k1(); ++c)
+        col_parity_line(blocks, slab, col_mat, c, off, len);
+}
+
+void Encoder::cross_parity_range(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                                 const CodingMatrix& col_mat, size_t off, size_t len) const {
+    for (int p = 0; p < slab.m1(); ++p)
+        cross_parity_line(blocks, slab, col_mat, p, off, len);
+}
+
+// generate_row_parity:
+// Row parity uses RS(k1, m1) from CodingMatrixRegistry, i.e. rows 1..m1 of
+// reed_sol_vandermonde_coding_matrix(k1, m1+1, 8) (consistent with prior Jerasure usage)
+// R[r][p] lives at slab.block(r, k1 + p)
+void Encoder::generate_row_parity(const std::vector<BlockView>& blocks, StripeSlab& slab) const {
+    if (slab.m1() == 0) return;
+
+    auto row_mat = CodingMatrixRegistry::instance().get(slab.k1(), slab.m1());
+    row_parity_range(blocks, slab, *row_mat, 0, slab.block_size());
+}
+
+// generate_col_parity_for_data:
+// For data columns only: RS(k2, m2) from the registry
+// produces C[q][c] for q in 0..m2-1, c in 0..k1-1
+// C[q][c] lives at slab.block(k2 + q, c)
+void Encoder::generate_col_parity_for_data(const std::vector<BlockView>& blocks, StripeSlab& slab) const {
+    if (slab.m2() == 0) return;
+
+    auto col_mat = CodingMatrixRegistry::instance().get(slab.k2(), slab.m2());
+    col_parity_range(blocks, slab, *col_mat, 0, slab.block_size());
 }
 
 // generate_cross_parity_from_R:
 // Compute S[q][p] = column-parity applied to R[:,p]
-// Use same column Vandermonde as used for data columns: reed_sol_vandermonde_coding_matrix(k2, m2+1, 8)
-void Encoder::generate_cross_parity_from_R(const std::vector<std::vector<std::vector<uint8_t>>>& R,
-                                           std::vector<std::vector<std::vector<uint8_t>>>& S,
-                                           int k2, int m1, int m2, int block_size) {
-    S.assign(m2, std::vector<std::vector<uint8_t>>(m1, std::vector<uint8_t>(block_size, 0)));
+// Use same column matrix as used for data columns: RS(k2, m2)
+// S[q][p] lives at slab.block(k2 + q, k1 + p)
+void Encoder::generate_cross_parity_from_R(const std::vector<BlockView>& blocks, StripeSlab& slab) const {
+    if (slab.m2() == 0 || slab.m1() == 0) return;
 
-    if (m2 == 0 || m1 == 0) return;
+    auto col_mat = CodingMatrixRegistry::instance().get(slab.k2(), slab.m2());
+    cross_parity_range(blocks, slab, *col_mat, 0, slab.block_size());
+}
 
-    int *vand_col = reed_sol_vandermonde_coding_matrix(k2, m2 + 1, 8); // (m2+1) * k2
-    for (int q = 0; q < m2; ++q) {
-        for (int p = 0; p < m1; ++p) {
-            for (int r = 0; r < k2; ++r) {
-                int idx = (q + 1) * k2 + r; // row (q+1)
-                uint8_t coef = static_cast<uint8_t>(vand_col[idx] & 0xFF);
-                for (int b = 0; b < block_size; ++b) {
-                    S[q][p][b] ^= gf256_mul(coef, R[r][p][b]);
+// encode_fused:
+// Single pass over the stripe in strips of strip_for() bytes. For each strip
+// R, C and S are produced back to back while the D (and R) strip is still in
+// L1/L2, instead of streaming whole blocks three times. Every output byte
+// sees the same XOR sequence as the three-pass path, so results are identical.
+void Encoder::encode_fused(const std::vector<BlockView>& blocks, StripeSlab& slab) const {
+    int m1 = slab.m1(), m2 = slab.m2();
+    size_t block_size = slab.block_size();
+
+    auto row_mat = CodingMatrixRegistry::instance().get(slab.k1(), m1);
+    auto col_mat = CodingMatrixRegistry::instance().get(slab.k2(), m2);
+    const size_t strip = strip_for(slab);
+
+    for (size_t off = 0; off < block_size; off += strip) {
+        size_t len = std::min(strip, block_size - off);
+        if (m1 > 0) row_parity_range(blocks, slab, *row_mat, off, len);
+        if (m2 > 0) col_parity_range(blocks, slab, *col_mat, off, len);
+        if (m1 > 0 && m2 > 0) cross_parity_range(blocks, slab, *col_mat, off, len);
+    }
+}
+
+// encode_parallel:
+// Intra-stripe parallelism on pool_. Byte ranges of range_size_ are split
+// further into independent tasks:
+//   FUSED:      one task per range (R, C, S of that range, strip by strip)
+//   THREE_PASS: phase 1 = one task per (row, range) for R and per
+//               (data column, range) for C; phase 2 = one task per
+//               (parity column, range) for S, which needs R finished.
+// Each output byte still sees the sequential XOR order, so output is identical.
+// The coding matrices are shared read-only by all tasks.
+void Encoder::encode_parallel(const std::vector<BlockView>& blocks, StripeSlab& slab) const {
+    int k1 = slab.k1(), m1 = slab.m1(), k2 = slab.k2(), m2 = slab.m2();
+    size_t block_size = slab.block_size();
+
+    auto row_mat_ptr = CodingMatrixRegistry::instance().get(k1, m1);
+    auto col_mat_ptr = CodingMatrixRegistry::instance().get(k2, m2);
+    const CodingMatrix& row_mat = *row_mat_ptr;
+    const CodingMatrix& col_mat = *col_mat_ptr;
+
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (size_t off = 0; off < block_size; off += range_size_)
+        ranges.emplace_back(off, std::min(range_size_, block_size - off));
+
+    if (mode_ == EncodeMode::FUSED) {
+        const size_t strip = strip_for(slab);
+        TaskGroup group(*pool_);
+        for (const auto& rg : ranges) {
+            group.run([&, rg]() {
+                for (size_t off = rg.first; off < rg.first + rg.second; off += strip) {
+                    size_t len = std::min(strip, rg.first + rg.second - off);
+                    if (m1 > 0) row_parity_range(blocks, slab, row_mat, off, len);
+                    if (m2 > 0) col_parity_range(blocks, slab, col_mat, off, len);
+                    if (m1 > 0 && m2 > 0) cross_parity_range(blocks, slab, col_mat, off, len);
                 }
-            }
+            });
         }
-    }
-    delete[] vand_col;
-}
-
-// Flatten the 2D PC matrix in true row-major order:
-// Matrix shape = (k2 + m2) rows × (k1 + m1) cols
-// Row 0..k2-1: [ D | R ]
-// Row k2..k2+m2-1: [ C | S ]
-std::unordered_map<int, std::string> Encoder::flatten_blocks(
-    const std::vector<std::vector<std::vector<uint8_t>>>& D,  // k2 x k1
-    const std::vector<std::vector<std::vector<uint8_t>>>& R,  // k2 x m1
-    const std::vector<std::vector<std::vector<uint8_t>>>& C,  // m2 x k1
-    const std::vector<std::vector<std::vector<uint8_t>>>& S,  // m2 x m1
-    int k1, int m1, int k2, int m2, int block_size)
-{
-    std::unordered_map<int, std::string> result;
-    int id = 0;
-
-    int total_rows = k2 + m2;
-    int total_cols = k1 + m1;
-
-    for (int r = 0; r < total_rows; ++r) {
-        for (int c = 0; c < total_cols; ++c) {
-
-            const uint8_t* ptr = nullptr;
-
-            if (r < k2 && c < k1) {
-                // data block
-                ptr = D[r][c].data();
-            } 
-            else if (r < k2 && c >= k1) {
-                // row parity block
-                int p = c - k1;
-                ptr = R[r][p].data();
-            } 
-            else if (r >= k2 && c < k1) {
-                // column parity block
-                int q = r - k2;
-                ptr = C[q][c].data();
-            } 
-            else {
-                // cross parity block
-                int q = r - k2;
-                int p = c - k1;
-                ptr = S[q][p].data();
-            }
+        group.wait();
+    } else {
+        TaskGroup phase1(*pool_);
+        for (const auto& rg : ranges) {
+            if (m1 > 0)
+                for (int r = 0; r < k2; ++r)
+                    phase1.run([&, rg, r]() { row_parity_line(blocks, slab, row_mat, r, rg.first, rg.second); });
+            if (m2 > 0)
+                for (int c = 0; c < k1; ++c)
+                    phase1.run([&, rg, c]() { col_parity_line(blocks, slab, col_mat, c, rg.first, rg.second); });
+        }
+        phase1.wait();
 
-            result[id++] = std::string(reinterpret_cast<const char*>(ptr), block_size);
+        if (m1 > 0 && m2 > 0) {
+            TaskGroup phase2(*pool_);
+            for (const auto& rg : ranges)
+                for (int p = 0; p < m1; ++p)
+                    phase2.run([&, rg, p]() { cross_parity_line(blocks, slab, col_mat, p, rg.first, rg.second); });
+            phase2.wait();
         }
     }
+}
 
-    return result;
+void Encoder::set_strip_size(size_t strip_size) {
+    // keep strips a multiple of the slab alignment so SIMD loops stay full width
+    size_t a = StripeSlab::kAlign;
+    strip_size_ = strip_size == 0 ? 0 : std::max(a, (strip_size + a - 1) / a * a);
+}
+
+size_t Encoder::strip_for(const StripeSlab& slab) const {
+    if (strip_size_ > 0) return strip_size_;
+    size_t a = StripeSlab::kAlign;
+    size_t blocks = (size_t)(slab.k1() + slab.m1()) * (size_t)(slab.k2() + slab.m2());
+    size_t strip = kStripWorkingSet / std::max<size_t>(blocks, 1);
+    return std::max(a, strip / a * a);
 }
 
+void Encoder::set_range_size(size_t range_size) {
+    size_t a = StripeSlab::kAlign;
+    range_size_ = std::max(a, (range_size + a - 1) / a * a);
+}
+
+// encode_views:
+// `blocks` already points at the data blocks; parity views are (re)pointed at
+// their slab slots, then parity is generated in place
+std::vector<BlockView> Encoder::encode_views(std::vector<BlockView>& blocks, StripeSlab& slab) const {
+    int k1 = slab.k1(), k2 = slab.k2();
+    for (int id = 0; id < slab.block_count(); ++id) {
+        int r = id / slab.cols(), c = id % slab.cols();
+        if (r >= k2 || c >= k1) blocks[id] = slab.view(id);
+    }
+
+    if (pool_ != nullptr) {
+        encode_parallel(blocks, slab);
+        return blocks;
+    }
+
+    if (mode_ == EncodeMode::FUSED) {
+        encode_fused(blocks, slab);
+        return blocks;
+    }
+
+    // R[r][p] row parity (k2 x m1)
+    generate_row_parity(blocks, slab);
 
-// top-level encode driver
+    // C[q][c] column parity for data columns (m2 x k1)
+    generate_col_parity_for_data(blocks, slab);
+
+    // S[q][p] cross parity (m2 x m1), computed from R's columns using same column coefficients
+    generate_cross_parity_from_R(blocks, slab);
+
+    return blocks;
+}
+
+// top-level encode driver (slab output)
+void Encoder::encode(const std::vector<std::string>& data_blocks,
+                     int k1, int m1, int k2, int m2,
+                     int block_size,
+                     StripeSlab& out) {
+    // reset zeroes every block, parity accumulates in place
+    out.reset(k1, m1, k2, m2, block_size);
+
+    // D[r][c]
+    reshape_data(data_blocks, out);
+
+    std::vector<BlockView> blocks = out.views();
+    encode_views(blocks, out);
+}
+
+// legacy encode driver: block_id -> std::string
 std::unordered_map<int, std::string> Encoder::encode(
     const std::vector<std::string>& data_blocks,
     int k1, int m1, int k2, int m2,
     int block_size) {
 
-    // Ensure GF tables prepared before calling encode (main should call init_tables())
-    // reshape D[r][c]
-    std::vector<std::vector<std::vector<uint8_t>>> D;
-    reshape_data(data_blocks, D, k1, k2, block_size);
+    StripeSlab slab;
+    encode(data_blocks, k1, m1, k2, m2, block_size, slab);
 
-    // R[r][p] row parity (k2 x m1)
-    std::vector<std::vector<std::vector<uint8_t>>> R;
-    generate_row_parity(D, R, k1, m1, k2, block_size);
+    std::unordered_map<int, std::string> result;
+    result.reserve(slab.block_count());
+    for (int id = 0; id < slab.block_count(); ++id) {
+        BlockView v = slab.view(id);
+        result[id] = std::string(reinterpret_cast<const char*>(v.data), v.len);
+    }
+    return result;
+}
 
-    // C[q][c] column parity for data columns (m2 x k1)
-    std::vector<std::vector<std::vector<uint8_t>>> C;
-    generate_col_parity_for_data(D, C, k1, k2, m2, block_size);
+// zero-copy encode driver: contiguous input buffer
+std::vector<BlockView> Encoder::encode(const uint8_t* data, size_t len,
+                                       int k1, int m1, int k2, int m2,
+                                       int block_size,
+                                       StripeSlab& arena) {
+    std::vector<BlockView> spans(k1 * k2);
+    for (int i = 0; i < k1 * k2; ++i) {
+        size_t off = (size_t)i * block_size;
+        if (off < len) {
+            spans[i].data = data + off;
+            spans[i].len = std::min<size_t>(len - off, (size_t)block_size);
+        }
+    }
+    return encode(spans, k1, m1, k2, m2, block_size, arena);
+}
 
-    // S[q][p] cross parity (m2 x m1), computed from R's columns using same column coefficients
-    std::vector<std::vector<std::vector<uint8_t>>> S;
-    generate_cross_parity_from_R(R, S, k2, m1, m2, block_size);
+// zero-copy encode driver: one span per data block
+std::vector<BlockView> Encoder::encode(const std::vector<BlockView>& data_spans,
+                                       int k1, int m1, int k2, int m2,
+                                       int block_size,
+                                       StripeSlab& arena) {
+    assert((int)data_spans.size() == k1 * k2);
+    arena.reset(k1, m1, k2, m2, block_size);
+
+    std::vector<BlockView> blocks(arena.block_count());
+    for (int r = 0; r < k2; ++r) {
+        for (int c = 0; c < k1; ++c) {
+            const BlockView& span = data_spans[r * k1 + c];
+            int id = r * arena.cols() + c;
+            if (span.len >= (size_t)block_size) {
+                // full block: reference the caller's bytes directly
+                blocks[id] = BlockView{span.data, (size_t)block_size};
+            } else {
+                // short block: needs zero padding, copy into the arena slot
+                if (span.len > 0) memcpy(arena.block(id), span.data, span.len);
+                blocks[id] = arena.view(id);
+            }
+        }
+    }
+    return encode_views(blocks, arena);
+}
 
-    return flatten_blocks(D, R, C, S, k1, m1, k2, m2, block_size);
+// multi-stripe driver: one pool task per stripe (each stripe task forks its
+// own parity tasks as well); sequential when no pool is set
+std::vector<std::vector<BlockView>> Encoder::encode_stripes(
+    const std::vector<std::vector<BlockView>>& stripes,
+    int k1, int m1, int k2, int m2,
+    int block_size,
+    std::vector<StripeSlab>& arenas) {
+
+    std::vector<std::vector<BlockView>> out(stripes.size());
+    if (arenas.size() < stripes.size()) arenas.resize(stripes.size());
+
+    if (pool_ == nullptr) {
+        for (size_t i = 0; i < stripes.size(); ++i)
+            out[i] = encode(stripes[i], k1, m1, k2, m2, block_size, arenas[i]);
+        return out;
+    }
+
+    TaskGroup group(*pool_);
+    for (size_t i = 0; i < stripes.size(); ++i) {
+        group.run([&, i]() {
+            out[i] = encode(stripes[i], k1, m1, k2, m2, block_size, arenas[i]);
+        });
+    }
+    group.wait();
+    return out;
 }
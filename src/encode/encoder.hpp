@@ -4,6 +4,15 @@
 #include <string>
 #include <unordered_map>
 
+#include "stripe_slab.hpp"
+#include "thread_pool.hpp"
+#include "coding_matrix.hpp"
+
+// Parity generation schedule. THREE_PASS walks D for R, walks D again for C,
+// then walks R for S. FUSED tiles the block length into strips and produces
+// R, C and S per strip while the strip is still cached; output is bit-identical.
+enum class EncodeMode { THREE_PASS, FUSED };
+
 // Encoder for Product Code PC(k1, m1, k2, m2)
 // Data layout:
 //   - data: k2 rows x k1 cols
@@ -11,44 +20,129 @@
 //   - col parity (for data columns): m2 rows x k1 cols (bottom left)
 //   - cross parity (shared): m2 rows x m1 cols (bottom right)  <-- same physical blocks
 //
-// flatten order (block_id increasing):
-// 1) data: r=0..k2-1, c=0..k1-1   => id = r*k1 + c
-// 2) row parity: r=0..k2-1, p=0..m1-1 => id = base_row + r*m1 + p
-// 3) col parity (for data columns): q=0..m2-1, c=0..k1-1 => id = base_col + q*k1 + c
-// 4) cross parity S: q=0..m2-1, p=0..m1-1 => id = base_cross + q*m1 + p
+// block_id is row-major over the full (k2 + m2) x (k1 + m1) grid:
+//   id = r * (k1 + m1) + c
+// rows 0..k2-1 hold [ D | R ], rows k2..k2+m2-1 hold [ C | S ].
+//
+// All blocks live in one StripeSlab; parity is generated in place, so the
+// only copy on the encode path is the input data landing in its slab slot.
 //
-// Requires Jerasure (reed_sol_vandermonde_coding_matrix) and gf256 solver (init_tables(), gf256_mul, gf256_pow, etc.)
+// Coding matrices come from CodingMatrixRegistry (built once per (k, m) via Jerasure's
+// reed_sol_vandermonde_coding_matrix); the registry initialises the GF tables itself.
 class Encoder {
 public:
+    // A FUSED strip touches that strip of every block: R and C both read the D
+    // strip, S reads the R strip, so the working set is (k1+m1)(k2+m2) x strip
+    // bytes. With strip size 0 (default) the strip is derived per stripe as
+    // kStripWorkingSet / block count, e.g. ~17 KB for 4+2 x 3+2 (30 blocks) and
+    // 2 KB for 12+4 x 12+4 (256 blocks).
+    static constexpr size_t kStripWorkingSet = 512 * 1024;
+
+    void set_mode(EncodeMode mode) { mode_ = mode; }
+    EncodeMode mode() const { return mode_; }
+
+    // strip length used by FUSED mode (rounded up to StripeSlab::kAlign);
+    // 0 = derive from the block count (see kStripWorkingSet)
+    void set_strip_size(size_t strip_size);
+    size_t strip_size() const { return strip_size_; }
+
+    // Parallel encoding. With a pool set, parity of one stripe is split into
+    // per-row / per-column / per-byte-range tasks (ranges of range_size bytes)
+    // and encode_stripes() runs one task per stripe. nullptr = single-threaded.
+    static constexpr size_t kDefaultRangeSize = 256 * 1024;
+
+    void set_thread_pool(ThreadPool* pool) { pool_ = pool; }
+    void set_range_size(size_t range_size);
+    size_t range_size() const { return range_size_; }
+
+    // Encode data_blocks (length == k1 * k2) into `out`. Each string may be
+    // shorter than block_size (will be zero-padded). Afterwards out.view(id)
+    // / out.views() give the encoded blocks indexed by block_id.
+    void encode(const std::vector<std::string>& data_blocks,
+                int k1, int m1, int k2, int m2,
+                int block_size,
+                StripeSlab& out);
+
     // Encode data_blocks (length == k1 * k2). Each string may be shorter than block_size (will be zero-padded).
     // Returns mapping block_id -> block bytes (std::string of length block_size).
+    // Kept for existing callers; copies every block out of the slab.
     std::unordered_map<int, std::string> encode(
         const std::vector<std::string>& data_blocks,
         int k1, int m1, int k2, int m2,
         int block_size);
 
+    // Zero-copy encode from one contiguous caller buffer holding the k1 * k2
+    // data blocks back to back (len may be short; the tail is zero-padded).
+    // Parity is written into the caller-owned `arena`; full-length data blocks
+    // are not copied, their views point straight into `data`. Returns dense
+    // views indexed by block_id, valid while both `data` and `arena` are.
+    std::vector<BlockView> encode(const uint8_t* data, size_t len,
+                                  int k1, int m1, int k2, int m2,
+                                  int block_size,
+                                  StripeSlab& arena);
+
+    // Same, iovec-style: one span per data block (k1 * k2 spans, each may be
+    // shorter than block_size). Short spans are zero-padded inside the arena.
+    std::vector<BlockView> encode(const std::vector<BlockView>& data_spans,
+                                  int k1, int m1, int k2, int m2,
+                                  int block_size,
+                                  StripeSlab& arena);
+
+    // Encode many stripes (one span list per stripe) into arenas[i]
+    // (resized to stripes.size() if smaller). Returns per-stripe block views.
+    std::vector<std::vector<BlockView>> encode_stripes(
+        const std::vector<std::vector<BlockView>>& stripes,
+        int k1, int m1, int k2, int m2,
+        int block_size,
+        std::vector<StripeSlab>& arenas);
+
 private:
-    // helpers use uint8_t vectors internally
-    void reshape_data(const std::vector<std::string>& data_blocks,
-                      std::vector<std::vector<std::vector<uint8_t>>>& D,
-                      int k1, int k2, int block_size);
-
-    void generate_row_parity(const std::vector<std::vector<std::vector<uint8_t>>>& D,
-                             std::vector<std::vector<std::vector<uint8_t>>>& R,
-                             int k1, int m1, int k2, int block_size);
-
-    void generate_col_parity_for_data(const std::vector<std::vector<std::vector<uint8_t>>>& D,
-                                      std::vector<std::vector<std::vector<uint8_t>>>& C,
-                                      int k1, int k2, int m2, int block_size);
-
-    void generate_cross_parity_from_R(const std::vector<std::vector<std::vector<uint8_t>>>& R,
-                                      std::vector<std::vector<std::vector<uint8_t>>>& S,
-                                      int k2, int m1, int m2, int block_size);
-
-    std::unordered_map<int, std::string> flatten_blocks(
-        const std::vector<std::vector<std::vector<uint8_t>>>& D,
-        const std::vector<std::vector<std::vector<uint8_t>>>& R,
-        const std::vector<std::vector<std::vector<uint8_t>>>& C,
-        const std::vector<std::vector<std::vector<uint8_t>>>& S,
-        int k1, int m1, int k2, int m2, int block_size);
+    EncodeMode mode_ = EncodeMode::THREE_PASS;
+    size_t strip_size_ = 0;
+    size_t range_size_ = kDefaultRangeSize;
+    ThreadPool* pool_ = nullptr;
+
+    // copy input strings into the D region of the slab
+    void reshape_data(const std::vector<std::string>& data_blocks, StripeSlab& slab);
+
+    // The generators read sources through `blocks` (block_id indexed views;
+    // data views may point outside the slab) and write parity into the slab.
+
+    // R[r][p], written in place into the slab
+    void generate_row_parity(const std::vector<BlockView>& blocks, StripeSlab& slab) const;
+
+    // C[q][c] for data columns, written in place into the slab
+    void generate_col_parity_for_data(const std::vector<BlockView>& blocks, StripeSlab& slab) const;
+
+    // S[q][p] from the R columns, written in place into the slab
+    void generate_cross_parity_from_R(const std::vector<BlockView>& blocks, StripeSlab& slab) const;
+
+    // per-line kernels over [off, off + len) of the blocks of one row r /
+    // data column c / parity column p; units of work for the parallel path
+    void row_parity_line(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                         const CodingMatrix& row_mat, int r, size_t off, size_t len) const;
+    void col_parity_line(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                         const CodingMatrix& col_mat, int c, size_t off, size_t len) const;
+    void cross_parity_line(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                           const CodingMatrix& col_mat, int p, size_t off, size_t len) const;
+
+    // byte-range kernels shared by both modes: [off, off + len) of every block
+    void row_parity_range(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                          const CodingMatrix& row_mat, size_t off, size_t len) const;
+    void col_parity_range(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                          const CodingMatrix& col_mat, size_t off, size_t len) const;
+    void cross_parity_range(const std::vector<BlockView>& blocks, StripeSlab& slab,
+                            const CodingMatrix& col_mat, size_t off, size_t len) const;
+
+    // strip length for this slab: strip_size_, or derived from the block count
+    size_t strip_for(const StripeSlab& slab) const;
+
+    // FUSED mode: R, C and S strip by strip
+    void encode_fused(const std::vector<BlockView>& blocks, StripeSlab& slab) const;
+
+    // pool_ set: row/column/byte-range tasks on the work-stealing pool
+    void encode_parallel(const std::vector<BlockView>& blocks, StripeSlab& slab) const;
+
+    // run the generators for the current mode and return the block views
+    std::vector<BlockView> encode_views(std::vector<BlockView>& blocks, StripeSlab& slab) const;
 };
@@ -0,0 +1,57 @@
+#include "stripe_slab.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+StripeSlab::StripeSlab(int k1, int m1, int k2, int m2, int block_size) {
+    reset(k1, m1, k2, m2, block_size);
+}
+
+StripeSlab::~StripeSlab() {
+    release();
+}
+
+StripeSlab::StripeSlab(StripeSlab&& other) noexcept {
+    *this = std::move(other);
+}
+
+StripeSlab& StripeSlab::operator=(StripeSlab&& other) noexcept {
+    if (this != &other) {
+        release();
+        buf_ = other.buf_;           other.buf_ = nullptr;
+        capacity_ = other.capacity_; other.capacity_ = 0;
+        stride_ = other.stride_;
+        k1_ = other.k1_; m1_ = other.m1_; k2_ = other.k2_; m2_ = other.m2_;
+        block_size_ = other.block_size_;
+    }
+    return *this;
+}
+
+void StripeSlab::release() {
+    free(buf_);
+    buf_ = nullptr;
+    capacity_ = 0;
+}
+
+void StripeSlab::reset(int k1, int m1, int k2, int m2, int block_size) {
+    k1_ = k1; m1_ = m1; k2_ = k2; m2_ = m2;
+    block_size_ = block_size;
+    stride_ = ((size_t)block_size + kAlign - 1) / kAlign * kAlign;
+
+    size_t need = stride_ * (size_t)block_count();
+    if (need > capacity_) {
+        release();
+        void* p = nullptr;
+        if (posix_memalign(&p, kAlign, need) != 0) throw std::bad_alloc();
+        buf_ = static_cast<uint8_t*>(p);
+        capacity_ = need;
+    }
+    if (need > 0) memset(buf_, 0, need);
+}
+
+std::vector<BlockView> StripeSlab::views() const {
+    std::vector<BlockView> out(block_count());
+    for (int id = 0; id < block_count(); ++id) out[id] = view(id);
+    return out;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "block_view.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// StripeSlab: one aligned allocation holding the whole PC grid of a stripe.
+//
+// Grid shape = (k2 + m2) rows x (k1 + m1) cols, block_id = r * (k1 + m1) + c
+// (same row-major order the encoder has always used):
+//   rows 0..k2-1       : [ D | R ]
+//   rows k2..k2+m2-1   : [ C | S ]
+//
+// Every block starts on a 64-byte boundary (stride = block_size rounded up),
+// so SIMD kernels never straddle two blocks. reset() only reallocates when
+// the new geometry needs more room, so a slab can be reused across stripes.
+class StripeSlab {
+public:
+    static constexpr size_t kAlign = 64;
+
+    StripeSlab() = default;
+    StripeSlab(int k1, int m1, int k2, int m2, int block_size);
+    ~StripeSlab();
+
+    StripeSlab(const StripeSlab&) = delete;
+    StripeSlab& operator=(const StripeSlab&) = delete;
+    StripeSlab(StripeSlab&& other) noexcept;
+    StripeSlab& operator=(StripeSlab&& other) noexcept;
+
+    // (Re)shape the slab. Contents are zeroed.
+    void reset(int k1, int m1, int k2, int m2, int block_size);
+
+    int k1() const { return k1_; }
+    int m1() const { return m1_; }
+    int k2() const { return k2_; }
+    int m2() const { return m2_; }
+    int block_size() const { return block_size_; }
+    int rows() const { return k2_ + m2_; }
+    int cols() const { return k1_ + m1_; }
+    int block_count() const { return rows() * cols(); }
+
+    uint8_t* block(int block_id) { return buf_ + (size_t)block_id * stride_; }
+    const uint8_t* block(int block_id) const { return buf_ + (size_t)block_id * stride_; }
+    uint8_t* block(int r, int c) { return block(r * cols() + c); }
+    const uint8_t* block(int r, int c) const { return block(r * cols() + c); }
+
+    BlockView view(int block_id) const { return BlockView{block(block_id), (size_t)block_size_}; }
+
+    // Dense views indexed by block_id.
+    std::vector<BlockView> views() const;
+
+private:
+    uint8_t* buf_ = nullptr;
+    size_t capacity_ = 0;  // bytes allocated
+    size_t stride_ = 0;    // bytes between consecutive blocks
+    int k1_ = 0, m1_ = 0, k2_ = 0, m2_ = 0;
+    int block_size_ = 0;
+
+    void release();
+};
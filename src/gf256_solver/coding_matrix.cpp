@@ -0,0 +1,57 @@
+// coding_matrix.cpp
+#include "coding_matrix.hpp"
+#include "gf256_solver.hpp"
+
+#include <cstdlib>
+#include <jerasure.h>
+#include <jerasure/reed_sol.h>
+
+CodingMatrixRegistry& CodingMatrixRegistry::instance() {
+    static CodingMatrixRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<const CodingMatrix> CodingMatrixRegistry::get(int k, int m, int w) {
+    // 半字节表由 gf256_mul 构建：GF 表未初始化时会构建出全零表并一直缓存
+    init_tables();
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto key = std::make_tuple(k, m, w);
+    auto it = matrices_.find(key);
+    if (it != matrices_.end()) return it->second;
+
+    // Jerasure 的 galois 表惰性初始化不是线程安全的，构建放在锁内
+    auto mat = build(k, m, w);
+    matrices_[key] = mat;
+    return mat;
+}
+
+std::shared_ptr<const CodingMatrix> CodingMatrixRegistry::build(int k, int m, int w) {
+    auto mat = std::make_shared<CodingMatrix>();
+    mat->k = k;
+    mat->m = m;
+    mat->w = w;
+
+    mat->parity.assign(m * k, 0);
+    if (m > 0) {
+        int* vand = reed_sol_vandermonde_coding_matrix(k, m + 1, w); // (m+1) x k
+        for (int p = 0; p < m; ++p)
+            for (int c = 0; c < k; ++c)
+                mat->parity[p * k + c] = vand[(p + 1) * k + c];
+        free(vand);
+    }
+
+    mat->generator.assign((k + m) * k, 0);
+    for (int r = 0; r < k; ++r)
+        mat->generator[r * k + r] = 1;
+    for (int p = 0; p < m; ++p)
+        for (int c = 0; c < k; ++c)
+            mat->generator[(k + p) * k + c] = mat->parity[p * k + c];
+
+    if (w == 8) {
+        mat->tables.resize(m * k);
+        for (int i = 0; i < m * k; ++i)
+            gf256_build_nibble_table(static_cast<uint8_t>(mat->parity[i] & 0xFF), mat->tables[i]);
+    }
+
+    return mat;
+}
@@ -0,0 +1,53 @@
+// coding_matrix.hpp
+#ifndef CODING_MATRIX_HPP
+#define CODING_MATRIX_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+#include <cstdint>
+
+#include "gf256_region.hpp"
+
+// PC 编码使用的 RS(k, m) 编码矩阵
+// 与 Encoder / Repair 一致：取 reed_sol_vandermonde_coding_matrix(k, m+1, w)
+// 的第 1..m 行作为校验行（跳过全 1 的第 0 行）
+struct CodingMatrix {
+    int k = 0;
+    int m = 0;
+    int w = 8;
+
+    // m x k 校验系数，parity[p * k + c]
+    std::vector<int> parity;
+
+    // (k+m) x k 生成矩阵：上 k 行为单位阵，下 m 行为 parity
+    std::vector<int> generator;
+
+    // 与 parity 一一对应的半字节乘法表（仅 w == 8）
+    std::vector<gf256_nibble_table> tables;
+
+    uint8_t coef(int p, int c) const { return static_cast<uint8_t>(parity[p * k + c] & 0xFF); }
+    const gf256_nibble_table& table(int p, int c) const { return tables[p * k + c]; }
+};
+
+// 全局编码矩阵注册表：按 (k, m, w) 只构建一次，之后只读共享
+// get() 线程安全，返回的矩阵构建后不再修改，可被多个线程同时读取；
+// 首次 get() 前会先 init_tables()，不依赖调用方的初始化顺序
+class CodingMatrixRegistry {
+public:
+    static CodingMatrixRegistry& instance();
+
+    std::shared_ptr<const CodingMatrix> get(int k, int m, int w = 8);
+
+private:
+    CodingMatrixRegistry() = default;
+
+    std::mutex mtx_;
+    std::map<std::tuple<int, int, int>, std::shared_ptr<const CodingMatrix>> matrices_;
+
+    static std::shared_ptr<const CodingMatrix> build(int k, int m, int w);
+};
+
+#endif // CODING_MATRIX_HPP
@@ -0,0 +1,179 @@
+// gf256_region.cpp
+#include "gf256_region.hpp"
+#include "gf256_solver.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GF256_REGION_X86 1
+#endif
+
+void gf256_build_nibble_table(uint8_t coef, gf256_nibble_table& t) {
+    for (int i = 0; i < 16; ++i) {
+        t.lo[i] = gf256_mul(coef, static_cast<uint8_t>(i));
+        t.hi[i] = gf256_mul(coef, static_cast<uint8_t>(i << 4));
+    }
+}
+
+// ---------------------------------------------------------
+// 标量实现：同样按半字节查表，也用于 SIMD 实现的尾部
+// ---------------------------------------------------------
+template <bool XOR>
+static void region_scalar(uint8_t* dst, const uint8_t* src,
+                          const gf256_nibble_table& t, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t v = t.lo[src[i] & 0x0f] ^ t.hi[src[i] >> 4];
+        if (XOR) dst[i] ^= v;
+        else     dst[i] = v;
+    }
+}
+
+#ifdef GF256_REGION_X86
+// ---------------------------------------------------------
+// SSSE3：每次 16 字节
+// ---------------------------------------------------------
+template <bool XOR>
+__attribute__((target("ssse3")))
+static void region_ssse3(uint8_t* dst, const uint8_t* src,
+                         const gf256_nibble_table& t, size_t len) {
+    const __m128i tlo  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.lo));
+    const __m128i thi  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.hi));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_and_si128(x, mask);
+        __m128i hi = _mm_and_si128(_mm_srli_epi64(x, 4), mask);
+        __m128i v  = _mm_xor_si128(_mm_shuffle_epi8(tlo, lo), _mm_shuffle_epi8(thi, hi));
+        if (XOR) v = _mm_xor_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+    }
+    region_scalar<XOR>(dst + i, src + i, t, len - i);
+}
+
+// ---------------------------------------------------------
+// AVX2：每次 32 字节（vpshufb 在 128 位 lane 内查表，表需复制到两个 lane）
+// ---------------------------------------------------------
+template <bool XOR>
+__attribute__((target("avx2")))
+static void region_avx2(uint8_t* dst, const uint8_t* src,
+                        const gf256_nibble_table& t, size_t len) {
+    const __m256i tlo  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.lo)));
+    const __m256i thi  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.hi)));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i lo = _mm256_and_si256(x, mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi64(x, 4), mask);
+        __m256i v  = _mm256_xor_si256(_mm256_shuffle_epi8(tlo, lo), _mm256_shuffle_epi8(thi, hi));
+        if (XOR) v = _mm256_xor_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+    region_scalar<XOR>(dst + i, src + i, t, len - i);
+}
+
+// ---------------------------------------------------------
+// AVX-512BW：每次 64 字节
+// ---------------------------------------------------------
+template <bool XOR>
+__attribute__((target("avx512f,avx512bw")))
+static void region_avx512(uint8_t* dst, const uint8_t* src,
+                          const gf256_nibble_table& t, size_t len) {
+    const __m512i tlo  = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.lo)));
+    const __m512i thi  = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.hi)));
+    const __m512i mask = _mm512_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i x  = _mm512_loadu_si512(src + i);
+        __m512i lo = _mm512_and_si512(x, mask);
+        __m512i hi = _mm512_and_si512(_mm512_srli_epi64(x, 4), mask);
+        __m512i v  = _mm512_xor_si512(_mm512_shuffle_epi8(tlo, lo), _mm512_shuffle_epi8(thi, hi));
+        if (XOR) v = _mm512_xor_si512(v, _mm512_loadu_si512(dst + i));
+        _mm512_storeu_si512(dst + i, v);
+    }
+    region_scalar<XOR>(dst + i, src + i, t, len - i);
+}
+#endif // GF256_REGION_X86
+
+// ---------------------------------------------------------
+// 运行时分派：首次调用时探测 CPU，结果缓存
+// 环境变量 GF256_REGION_BACKEND 可强制降级（scalar/ssse3/avx2），便于对比测试
+// ---------------------------------------------------------
+typedef void (*region_fn)(uint8_t*, const uint8_t*, const gf256_nibble_table&, size_t);
+
+struct region_dispatch {
+    region_fn mul_xor;
+    region_fn mul;
+    const char* name;
+};
+
+static region_dispatch select_dispatch() {
+    const char* force = std::getenv("GF256_REGION_BACKEND");
+    auto allowed = [force](const char* name) {
+        return force == nullptr || std::strcmp(force, name) == 0;
+    };
+
+#ifdef GF256_REGION_X86
+    __builtin_cpu_init();
+    if (allowed("avx512") && __builtin_cpu_supports("avx512bw"))
+        return {region_avx512<true>, region_avx512<false>, "avx512"};
+    if (allowed("avx2") && __builtin_cpu_supports("avx2"))
+        return {region_avx2<true>, region_avx2<false>, "avx2"};
+    if (allowed("ssse3") && __builtin_cpu_supports("ssse3"))
+        return {region_ssse3<true>, region_ssse3<false>, "ssse3"};
+#else
+    (void)allowed;
+#endif
+    return {region_scalar<true>, region_scalar<false>, "scalar"};
+}
+
+static const region_dispatch& dispatch() {
+    static const region_dispatch d = select_dispatch();
+    return d;
+}
+
+const char* gf256_region_backend() {
+    return dispatch().name;
+}
+
+// ---------------------------------------------------------
+// 对外接口
+// ---------------------------------------------------------
+void gf256_region_mul_xor_tbl(uint8_t* dst, const uint8_t* src,
+                              const gf256_nibble_table& t, size_t len) {
+    dispatch().mul_xor(dst, src, t, len);
+}
+
+void gf256_region_mul_tbl(uint8_t* dst, const uint8_t* src,
+                          const gf256_nibble_table& t, size_t len) {
+    dispatch().mul(dst, src, t, len);
+}
+
+void gf256_region_xor(uint8_t* dst, const uint8_t* src, size_t len) {
+    for (size_t i = 0; i < len; ++i)
+        dst[i] ^= src[i];
+}
+
+void gf256_region_mul_xor(uint8_t* dst, const uint8_t* src, uint8_t coef, size_t len) {
+    if (coef == 0) return;
+    if (coef == 1) { gf256_region_xor(dst, src, len); return; }
+
+    gf256_nibble_table t;
+    gf256_build_nibble_table(coef, t);
+    gf256_region_mul_xor_tbl(dst, src, t, len);
+}
+
+void gf256_region_mul(uint8_t* dst, const uint8_t* src, uint8_t coef, size_t len) {
+    if (coef == 0) { memset(dst, 0, len); return; }
+    if (coef == 1) { if (dst != src) memmove(dst, src, len); return; }
+
+    gf256_nibble_table t;
+    gf256_build_nibble_table(coef, t);
+    gf256_region_mul_tbl(dst, src, t, len);
+}
@@ -0,0 +1,43 @@
+// gf256_region.hpp
+#ifndef GF256_REGION_HPP
+#define GF256_REGION_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// 区域运算（region operations）：对整段缓冲区做 GF(256) 乘法 / 乘加
+// 采用 split-table（高低半字节查表）方法：
+//   coef * x = lo[x & 0x0f] ^ hi[x >> 4]
+// x86 上使用 pshufb（SSSE3 / AVX2 / AVX-512BW）一次查 16/32/64 字节，
+// 运行时根据 CPU 特性选择实现，其他平台退回标量查表。
+//
+// 依赖 gf256_mul，调用前需先 init_tables()。
+
+// 某个系数对应的半字节乘法表（32 字节）
+struct gf256_nibble_table {
+    alignas(16) uint8_t lo[16];  // lo[i] = coef * i
+    alignas(16) uint8_t hi[16];  // hi[i] = coef * (i << 4)
+};
+
+// 为 coef 构造半字节表
+void gf256_build_nibble_table(uint8_t coef, gf256_nibble_table& t);
+
+// dst[i] ^= coef * src[i]
+void gf256_region_mul_xor(uint8_t* dst, const uint8_t* src, uint8_t coef, size_t len);
+
+// dst[i] = coef * src[i]   (dst 与 src 可以是同一块内存)
+void gf256_region_mul(uint8_t* dst, const uint8_t* src, uint8_t coef, size_t len);
+
+// 使用预先构造好的表（系数固定、反复调用时避免重复建表）
+void gf256_region_mul_xor_tbl(uint8_t* dst, const uint8_t* src,
+                              const gf256_nibble_table& t, size_t len);
+void gf256_region_mul_tbl(uint8_t* dst, const uint8_t* src,
+                          const gf256_nibble_table& t, size_t len);
+
+// dst[i] ^= src[i]
+void gf256_region_xor(uint8_t* dst, const uint8_t* src, size_t len);
+
+// 当前选中的实现名称："avx512" / "avx2" / "ssse3" / "scalar"
+const char* gf256_region_backend();
+
+#endif // GF256_REGION_HPP
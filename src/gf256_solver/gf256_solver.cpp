@@ -1,13 +1,15 @@
 // gf256_solver.cpp
 #include "gf256_solver.hpp"
+#include "gf256_region.hpp"
 #include <cassert>
 #include <iostream>
+#include <mutex>
 
 static const int GF_SIZE = 256;
 static uint8_t gf_log[GF_SIZE];
 static uint8_t gf_exp[2 * GF_SIZE];
 
-void init_tables() {
+static void build_tables() {
     int poly = 0x11d;
     gf_exp[0] = 1;
     for (int i = 1; i < 512; ++i) {
@@ -20,6 +22,11 @@ void init_tables() {
         gf_log[gf_exp[i]] = i;
 }
 
+void init_tables() {
+    static std::once_flag once;
+    std::call_once(once, build_tables);
+}
+
 uint8_t gf256_mul(uint8_t a, uint8_t b) {
     if (a == 0 || b == 0) return 0;
     int log_a = gf_log[a];
@@ -89,19 +96,17 @@ bool gf256_gaussian_elimination(const std::vector<std::vector<int>>& A,
         uint8_t inv = gf256_inv(mat[i][i]);
         for (int j = 0; j < n; ++j)
             mat[i][j] = gf256_mul(mat[i][j], inv) & 0xFF;
-        for (int j = 0; j < m; ++j)
-            rhs[i][j] = gf256_mul(rhs[i][j], inv) & 0xFF;
+        gf256_region_mul(rhs[i].data(), rhs[i].data(), inv, m);
 
         // 消元：将其他行第 i 列清零
         for (int r = 0; r < n; ++r) {
             if (r == i) continue;
             uint8_t factor = mat[r][i];
+            if (factor == 0) continue;
             for (int j = 0; j < n; ++j) {
                 mat[r][j] = mat[r][j] ^ gf256_mul(factor, mat[i][j]) & 0xFF;
             }
-            for (int j = 0; j < m; ++j) {
-                rhs[r][j] = rhs[r][j] ^ gf256_mul(factor, rhs[i][j]) & 0xFF;
-            }
+            gf256_region_mul_xor(rhs[r].data(), rhs[i].data(), factor, m);
         }
     }
 
@@ -5,6 +5,7 @@
 #include <vector>
 #include <cstdint>
 
+// 构建 log / exp 表。只在第一次调用时构建，可重复、并发调用
 void init_tables();
 
 uint8_t gf256_mul(uint8_t a, uint8_t b);
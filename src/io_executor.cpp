@@ -0,0 +1,44 @@
+#include "io_executor.hpp"
+
+IoExecutor::IoExecutor(int threads) {
+    if (threads <= 0) threads = kDefaultThreads;
+    for (int i = 0; i < threads; ++i)
+        workers_.emplace_back(&IoExecutor::worker_loop, this);
+}
+
+IoExecutor::~IoExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+IoExecutor& IoExecutor::shared() {
+    static IoExecutor executor;
+    return executor;
+}
+
+void IoExecutor::submit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void IoExecutor::worker_loop() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+            // 退出前先把队列里剩余的任务执行完
+            if (tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
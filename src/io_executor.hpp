@@ -0,0 +1,97 @@
+//io_executor.hpp
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Results of I/O tasks in completion order. The submitting thread pops them
+// as they finish instead of joining one future per request. An exception
+// thrown by a task is rethrown from pop().
+template <typename T>
+class CompletionQueue {
+public:
+    void push(T value) {
+        // notify under the lock: once pop() sees the item the owner may
+        // destroy the queue, so nothing may touch it after the unlock
+        std::lock_guard<std::mutex> lock(mtx_);
+        items_.push_back(Item{std::optional<T>(std::move(value)), nullptr});
+        cv_.notify_one();
+    }
+
+    void push_error(std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(mtx_);  // see push()
+        items_.push_back(Item{std::nullopt, error});
+        cv_.notify_one();
+    }
+
+    // Blocks until one result is available.
+    T pop() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this]() { return !items_.empty(); });
+        Item item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        if (item.error) std::rethrow_exception(item.error);
+        return std::move(*item.value);
+    }
+
+private:
+    struct Item {
+        std::optional<T> value;
+        std::exception_ptr error;
+    };
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Item> items_;
+};
+
+// Fixed-size executor for blocking memcached I/O (survivor fetches,
+// write-backs, stripe writes). Unlike ThreadPool it is plain FIFO without
+// helping: tasks block on the network, not on each other, and must not
+// wait for other tasks of the same executor.
+class IoExecutor {
+public:
+    using Task = std::function<void()>;
+
+    static constexpr int kDefaultThreads = 16;
+
+    explicit IoExecutor(int threads = kDefaultThreads);
+    ~IoExecutor();
+
+    IoExecutor(const IoExecutor&) = delete;
+    IoExecutor& operator=(const IoExecutor&) = delete;
+
+    // Process-wide executor used when no other one is configured.
+    static IoExecutor& shared();
+
+    int size() const { return (int)workers_.size(); }
+
+    void submit(Task task);
+
+    // Run f() on the executor and push its result (or exception) to cq.
+    template <typename T, typename F>
+    void submit(CompletionQueue<T>& cq, F f) {
+        submit([&cq, f]() mutable {
+            try {
+                cq.push(f());
+            } catch (...) {
+                cq.push_error(std::current_exception());
+            }
+        });
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Task> tasks_;
+    bool stop_ = false;
+
+    void worker_loop();
+};
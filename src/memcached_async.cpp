@@ -0,0 +1,538 @@
+#include "memcached_async.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// ---------------------------------------------------------
+// 二进制协议（memcached binary protocol）
+// 请求/响应头固定 24 字节，多字节字段为大端
+// ---------------------------------------------------------
+namespace {
+
+const uint8_t kMagicRequest  = 0x80;
+const uint8_t kMagicResponse = 0x81;
+const uint8_t kOpGet = 0x00;
+const uint8_t kOpSet = 0x01;
+const size_t  kHeaderSize = 24;
+const size_t  kReadChunk  = 64 * 1024;
+
+void put_u16(std::string& out, uint16_t v) {
+    out.push_back((char)(v >> 8));
+    out.push_back((char)(v & 0xff));
+}
+
+void put_u32(std::string& out, uint32_t v) {
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back((char)((v >> shift) & 0xff));
+}
+
+uint16_t get_u16(const char* p) {
+    const uint8_t* u = reinterpret_cast<const uint8_t*>(p);
+    return (uint16_t)((u[0] << 8) | u[1]);
+}
+
+uint32_t get_u32(const char* p) {
+    const uint8_t* u = reinterpret_cast<const uint8_t*>(p);
+    return ((uint32_t)u[0] << 24) | ((uint32_t)u[1] << 16) | ((uint32_t)u[2] << 8) | u[3];
+}
+
+// 把一个请求追加到发送缓冲：header + extras + key + value
+void encode_request(std::string& out, uint8_t opcode, uint32_t opaque,
+                    const std::string& key, const char* value, size_t value_len) {
+    uint8_t extras_len = (opcode == kOpSet) ? 8 : 0;   // SET: flags(4) + expiration(4)
+    uint32_t body_len = extras_len + (uint32_t)key.size() + (uint32_t)value_len;
+
+    out.push_back((char)kMagicRequest);
+    out.push_back((char)opcode);
+    put_u16(out, (uint16_t)key.size());
+    out.push_back((char)extras_len);
+    out.push_back(0);                 // data type
+    put_u16(out, 0);                  // vbucket
+    put_u32(out, body_len);
+    put_u32(out, opaque);
+    put_u32(out, 0);                  // cas
+    put_u32(out, 0);
+    if (extras_len) {
+        put_u32(out, 0);              // flags
+        put_u32(out, 0);              // expiration
+    }
+    out.append(key);
+    out.append(value, value_len);
+}
+
+} // namespace
+
+struct MemcachedAsyncEngine::Request {
+    uint8_t opcode;
+    std::string key;
+    std::string value;
+    // SET 的 value 在调用方缓冲区（不拥有）：编码进发送缓冲时才拷贝
+    const char* src = nullptr;
+    size_t src_len = 0;
+    AsyncGetCallback get_cb;
+    AsyncSetCallback set_cb;
+    // GET 到调用方缓冲区：value 直接写入 dst（最多 dst_cap 字节）
+    uint8_t* dst = nullptr;
+    size_t dst_cap = 0;
+    AsyncGetIntoCallback into_cb;
+
+    void fail(const std::string& why) {
+        if (into_cb) {
+            into_cb(false, 0);
+        } else if (opcode == kOpGet) {
+            AsyncGetResult r;
+            r.error = why;
+            if (get_cb) get_cb(std::move(r));
+        } else if (set_cb) {
+            set_cb(false);
+        }
+    }
+};
+
+// ---------------------------------------------------------
+// 单个事件循环：一个 epoll 实例 + 一个 eventfd（用于唤醒），
+// 每个 server 一条非阻塞连接；连接上的响应按请求顺序返回
+// ---------------------------------------------------------
+class MemcachedAsyncEngine::Loop {
+public:
+    Loop();
+    ~Loop();
+
+    void post(const std::string& server_ip, int port, Request&& req);
+
+private:
+    struct Connection {
+        int fd = -1;
+        bool connected = false;
+        std::string server;
+        std::string out;          // 待发送字节
+        size_t out_off = 0;
+        std::string in;           // 已收到、尚未解析的字节
+        std::deque<std::pair<uint32_t, Request>> pending;  // 已发送、等待响应
+        bool want_write = false;
+
+        // 直读模式：GET-into 响应头已解析，value 剩余部分直接 recv 进调用方缓冲区
+        bool direct = false;
+        Request direct_req;
+        size_t direct_len = 0;    // value 总长
+        size_t direct_got = 0;    // 已写入 dst 的字节
+    };
+
+    struct Posted {
+        std::string ip;
+        int port;
+        Request req;
+    };
+
+    int epfd_ = -1;
+    int wakefd_ = -1;
+    std::thread thread_;
+    std::mutex inbox_mtx_;
+    std::vector<Posted> inbox_;
+    bool stop_ = false;
+
+    // 以下只在 loop 线程访问
+    std::unordered_map<std::string, std::unique_ptr<Connection>> conns_;
+    std::unordered_map<int, Connection*> by_fd_;
+    uint32_t next_opaque_ = 1;
+
+    void run();
+    void drain_inbox();
+    Connection* connection_for(const std::string& ip, int port);
+    void update_interest(Connection* c);
+    void on_writable(Connection* c);
+    void on_readable(Connection* c);
+    bool parse_responses(Connection* c);
+    void finish_direct(Connection* c);
+    void close_connection(Connection* c, const std::string& why);
+};
+
+MemcachedAsyncEngine::Loop::Loop() {
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakefd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epfd_ < 0 || wakefd_ < 0) {
+        std::cerr << "[AsyncEngine] epoll/eventfd setup failed: " << strerror(errno) << std::endl;
+        return;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = wakefd_;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, wakefd_, &ev);
+    thread_ = std::thread(&Loop::run, this);
+}
+
+MemcachedAsyncEngine::Loop::~Loop() {
+    {
+        std::lock_guard<std::mutex> lock(inbox_mtx_);
+        stop_ = true;
+    }
+    if (wakefd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(wakefd_, &one, sizeof(one));
+        (void)n;
+    }
+    if (thread_.joinable()) thread_.join();
+
+    // loop 已退出：未发出的和未收到响应的请求都以失败结束
+    for (auto& p : inbox_) p.req.fail("engine stopped");
+    for (auto& kv : conns_) {
+        if (kv.second->direct) kv.second->direct_req.fail("engine stopped");
+        for (auto& pr : kv.second->pending) pr.second.fail("engine stopped");
+        if (kv.second->fd >= 0) close(kv.second->fd);
+    }
+    if (wakefd_ >= 0) close(wakefd_);
+    if (epfd_ >= 0) close(epfd_);
+}
+
+void MemcachedAsyncEngine::Loop::post(const std::string& server_ip, int port, Request&& req) {
+    bool accepted = false;
+    {
+        std::lock_guard<std::mutex> lock(inbox_mtx_);
+        if (!stop_ && thread_.joinable()) {
+            inbox_.push_back(Posted{server_ip, port, std::move(req)});
+            accepted = true;
+        }
+    }
+    if (!accepted) {
+        req.fail("engine not running");
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t n = write(wakefd_, &one, sizeof(one));
+    (void)n;
+}
+
+void MemcachedAsyncEngine::Loop::run() {
+    const int kMaxEvents = 64;
+    struct epoll_event events[kMaxEvents];
+
+    for (;;) {
+        int n = epoll_wait(epfd_, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[AsyncEngine] epoll_wait failed: " << strerror(errno) << std::endl;
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakefd_) {
+                uint64_t cnt;
+                while (read(wakefd_, &cnt, sizeof(cnt)) > 0) {}
+                {
+                    std::lock_guard<std::mutex> lock(inbox_mtx_);
+                    if (stop_) return;
+                }
+                drain_inbox();
+                continue;
+            }
+
+            auto it = by_fd_.find(fd);
+            if (it == by_fd_.end()) continue;
+            Connection* c = it->second;
+            uint32_t ev = events[i].events;
+
+            if (ev & EPOLLOUT) on_writable(c);
+            // on_writable 可能已关闭连接
+            if (by_fd_.count(fd) == 0) continue;
+            if (ev & (EPOLLIN | EPOLLHUP | EPOLLERR)) on_readable(c);
+        }
+    }
+}
+
+void MemcachedAsyncEngine::Loop::drain_inbox() {
+    std::vector<Posted> batch;
+    {
+        std::lock_guard<std::mutex> lock(inbox_mtx_);
+        batch.swap(inbox_);
+    }
+
+    for (auto& p : batch) {
+        Connection* c = connection_for(p.ip, p.port);
+        if (!c) {
+            p.req.fail("connect failed");
+            continue;
+        }
+        uint32_t opaque = next_opaque_++;
+        if (p.req.src) encode_request(c->out, p.req.opcode, opaque, p.req.key, p.req.src, p.req.src_len);
+        else encode_request(c->out, p.req.opcode, opaque, p.req.key, p.req.value.data(), p.req.value.size());
+        // 请求已编码进发送缓冲，value 不再需要
+        std::string().swap(p.req.value);
+        c->pending.emplace_back(opaque, std::move(p.req));
+        if (c->connected) on_writable(c);
+        else update_interest(c);
+    }
+}
+
+MemcachedAsyncEngine::Loop::Connection*
+MemcachedAsyncEngine::Loop::connection_for(const std::string& ip, int port) {
+    std::string server = ip + ":" + std::to_string(port);
+    auto it = conns_.find(server);
+    if (it != conns_.end()) return it->second.get();
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "[AsyncEngine] Invalid server address " << server << std::endl;
+        return nullptr;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return nullptr;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    std::unique_ptr<Connection> c(new Connection());
+    c->fd = fd;
+    c->server = server;
+    int rc = connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    if (rc == 0) {
+        c->connected = true;
+    } else if (errno != EINPROGRESS) {
+        std::cerr << "[AsyncEngine] connect to " << server << " failed: " << strerror(errno) << std::endl;
+        close(fd);
+        return nullptr;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT;   // 连接建立后可写，由 on_writable 收尾
+    ev.data.fd = fd;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev);
+    c->want_write = true;
+
+    Connection* raw = c.get();
+    by_fd_[fd] = raw;
+    conns_[server] = std::move(c);
+    return raw;
+}
+
+void MemcachedAsyncEngine::Loop::update_interest(Connection* c) {
+    bool want_write = !c->connected || c->out_off < c->out.size();
+    if (want_write == c->want_write) return;
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    if (want_write) ev.events |= EPOLLOUT;
+    ev.data.fd = c->fd;
+    epoll_ctl(epfd_, EPOLL_CTL_MOD, c->fd, &ev);
+    c->want_write = want_write;
+}
+
+void MemcachedAsyncEngine::Loop::on_writable(Connection* c) {
+    if (!c->connected) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) {
+            close_connection(c, std::string("connect: ") + strerror(err));
+            return;
+        }
+        c->connected = true;
+    }
+
+    while (c->out_off < c->out.size()) {
+        ssize_t n = send(c->fd, c->out.data() + c->out_off, c->out.size() - c->out_off, MSG_NOSIGNAL);
+        if (n > 0) {
+            c->out_off += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            close_connection(c, std::string("send: ") + strerror(errno));
+            return;
+        }
+    }
+    if (c->out_off == c->out.size()) {
+        c->out.clear();
+        c->out_off = 0;
+    }
+    update_interest(c);
+}
+
+void MemcachedAsyncEngine::Loop::on_readable(Connection* c) {
+    char buf[kReadChunk];
+    for (;;) {
+        ssize_t n;
+        if (c->direct)
+            n = recv(c->fd, c->direct_req.dst + c->direct_got, c->direct_len - c->direct_got, 0);
+        else
+            n = recv(c->fd, buf, sizeof(buf), 0);
+
+        if (n > 0) {
+            if (c->direct) {
+                c->direct_got += (size_t)n;
+                if (c->direct_got == c->direct_len) finish_direct(c);
+            } else {
+                c->in.append(buf, (size_t)n);
+                // 尽早解析，以便大 value 尽快切换到直读模式
+                if (!parse_responses(c)) return;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        // n == 0：对端关闭；其他错误
+        close_connection(c, n == 0 ? "connection closed" : std::string("recv: ") + strerror(errno));
+        return;
+    }
+}
+
+void MemcachedAsyncEngine::Loop::finish_direct(Connection* c) {
+    Request req = std::move(c->direct_req);
+    size_t len = c->direct_len;
+    c->direct = false;
+    c->direct_len = c->direct_got = 0;
+    if (req.into_cb) req.into_cb(true, len);
+}
+
+// 解析已收到的完整响应包，按顺序完成 pending 请求；返回 false 表示连接已关闭
+bool MemcachedAsyncEngine::Loop::parse_responses(Connection* c) {
+    size_t off = 0;
+    while (!c->direct && c->in.size() - off >= kHeaderSize) {
+        const char* h = c->in.data() + off;
+        uint32_t body_len = get_u32(h + 8);
+
+        if ((uint8_t)h[0] != kMagicResponse || c->pending.empty() ||
+            c->pending.front().first != get_u32(h + 12)) {
+            c->in.erase(0, off);
+            close_connection(c, "protocol error");
+            return false;
+        }
+
+        uint16_t key_len = get_u16(h + 2);
+        uint8_t extras_len = (uint8_t)h[4];
+        uint16_t status = get_u16(h + 6);
+        size_t skip = (size_t)extras_len + key_len;
+        size_t available = c->in.size() - off - kHeaderSize;
+        Request& front = c->pending.front().second;
+
+        if (available < body_len) {
+            // 包未收全。GET-into 且 value 放得下时，把已到的部分拷进 dst，
+            // 其余字节由 on_readable 直接 recv 到 dst，不再经过 in 缓冲
+            size_t value_len = body_len - skip;
+            if (status == 0 && front.dst && value_len <= front.dst_cap && available >= skip) {
+                size_t have = available - skip;
+                memcpy(front.dst, c->in.data() + off + kHeaderSize + skip, have);
+                c->direct = true;
+                c->direct_req = std::move(front);
+                c->direct_len = value_len;
+                c->direct_got = have;
+                c->pending.pop_front();
+                off = c->in.size();
+                if (have == value_len) finish_direct(c);
+            }
+            break;
+        }
+
+        const char* body = h + kHeaderSize;
+        Request req = std::move(front);
+        c->pending.pop_front();
+        off += kHeaderSize + body_len;
+
+        if (req.into_cb) {
+            size_t value_len = body_len - skip;
+            bool ok = (status == 0 && value_len <= req.dst_cap);
+            if (ok) memcpy(req.dst, body + skip, value_len);
+            req.into_cb(ok, ok ? value_len : 0);
+        } else if (req.opcode == kOpGet) {
+            AsyncGetResult r;
+            if (status == 0) {
+                r.ok = true;
+                r.value.assign(body + skip, body_len - skip);
+            } else {
+                r.error = (status == 1) ? "not found" : "status " + std::to_string(status);
+            }
+            if (req.get_cb) req.get_cb(std::move(r));
+        } else if (req.set_cb) {
+            req.set_cb(status == 0);
+        }
+    }
+    c->in.erase(0, off);
+    return true;
+}
+
+void MemcachedAsyncEngine::Loop::close_connection(Connection* c, const std::string& why) {
+    std::cerr << "[AsyncEngine] " << c->server << ": " << why << std::endl;
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, c->fd, nullptr);
+    close(c->fd);
+    by_fd_.erase(c->fd);
+
+    // 先从表中摘下，回调里再发请求时会重新建立连接
+    std::unique_ptr<Connection> owned = std::move(conns_[c->server]);
+    conns_.erase(c->server);
+    if (owned->direct) owned->direct_req.fail(why);
+    for (auto& pr : owned->pending) pr.second.fail(why);
+}
+
+// ---------------------------------------------------------
+// 对外接口
+// ---------------------------------------------------------
+MemcachedAsyncEngine::MemcachedAsyncEngine(int loops) {
+    if (loops <= 0) loops = (int)std::thread::hardware_concurrency();
+    if (loops <= 0) loops = 1;
+    for (int i = 0; i < loops; ++i) loops_.emplace_back(new Loop());
+}
+
+MemcachedAsyncEngine::~MemcachedAsyncEngine() {}
+
+void MemcachedAsyncEngine::dispatch(const std::string& server_ip, int port, Request&& req) {
+    Loop& loop = *loops_[next_loop_++ % loops_.size()];
+    loop.post(server_ip, port, std::move(req));
+}
+
+void MemcachedAsyncEngine::get(const std::string& server_ip, int port,
+                               const std::string& key, AsyncGetCallback cb) {
+    Request req;
+    req.opcode = kOpGet;
+    req.key = key;
+    req.get_cb = std::move(cb);
+    dispatch(server_ip, port, std::move(req));
+}
+
+void MemcachedAsyncEngine::get_into(const std::string& server_ip, int port,
+                                    const std::string& key, uint8_t* dst, size_t capacity,
+                                    AsyncGetIntoCallback cb) {
+    Request req;
+    req.opcode = kOpGet;
+    req.key = key;
+    req.dst = dst;
+    req.dst_cap = capacity;
+    req.into_cb = std::move(cb);
+    dispatch(server_ip, port, std::move(req));
+}
+
+void MemcachedAsyncEngine::set(const std::string& server_ip, int port,
+                               const std::string& key, std::string value, AsyncSetCallback cb) {
+    Request req;
+    req.opcode = kOpSet;
+    req.key = key;
+    req.value = std::move(value);
+    req.set_cb = std::move(cb);
+    dispatch(server_ip, port, std::move(req));
+}
+
+void MemcachedAsyncEngine::set(const std::string& server_ip, int port,
+                               const std::string& key, const char* value, size_t value_len,
+                               AsyncSetCallback cb) {
+    Request req;
+    req.opcode = kOpSet;
+    req.key = key;
+    req.src = value;
+    req.src_len = value_len;
+    req.set_cb = std::move(cb);
+    dispatch(server_ip, port, std::move(req));
+}
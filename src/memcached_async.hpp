@@ -0,0 +1,74 @@
+//memcached_async.hpp
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Result of an asynchronous GET. ok == false covers both "not found" and
+// connection errors; error holds a short description in that case.
+struct AsyncGetResult {
+    bool ok = false;
+    std::string value;
+    std::string error;
+};
+
+using AsyncGetCallback = std::function<void(AsyncGetResult)>;
+using AsyncSetCallback = std::function<void(bool ok)>;
+// GET into a caller buffer: len is the value length written to the buffer.
+// ok == false if the key is missing, the value exceeds the capacity or the
+// connection failed.
+using AsyncGetIntoCallback = std::function<void(bool ok, size_t len)>;
+
+// Event-driven memcached transport speaking the binary protocol over
+// non-blocking TCP sockets. Each event loop thread owns one epoll instance
+// and one connection per server; requests are spread round-robin over the
+// loops, so a few threads keep thousands of GET/SET requests in flight.
+//
+// Callbacks run on the loop thread and must not block. Requests still
+// pending when the engine is destroyed or a connection fails are completed
+// with ok == false.
+class MemcachedAsyncEngine {
+public:
+    // loops <= 0 -> std::thread::hardware_concurrency()
+    explicit MemcachedAsyncEngine(int loops = 0);
+    ~MemcachedAsyncEngine();
+
+    MemcachedAsyncEngine(const MemcachedAsyncEngine&) = delete;
+    MemcachedAsyncEngine& operator=(const MemcachedAsyncEngine&) = delete;
+
+    int loop_count() const { return (int)loops_.size(); }
+
+    void get(const std::string& server_ip, int port,
+             const std::string& key, AsyncGetCallback cb);
+
+    // Reads the value straight into dst[0, capacity). Once the response header
+    // has arrived the remaining value bytes are received from the socket
+    // directly into dst, with no intermediate buffer. dst must stay valid
+    // until the callback ran.
+    void get_into(const std::string& server_ip, int port,
+                  const std::string& key, uint8_t* dst, size_t capacity,
+                  AsyncGetIntoCallback cb);
+
+    // value is moved into the request and kept until the server replied
+    void set(const std::string& server_ip, int port,
+             const std::string& key, std::string value, AsyncSetCallback cb);
+
+    // value is read from the caller's buffer, which must stay valid until
+    // the callback ran (no copy besides the one into the send buffer)
+    void set(const std::string& server_ip, int port,
+             const std::string& key, const char* value, size_t value_len,
+             AsyncSetCallback cb);
+
+private:
+    class Loop;
+    struct Request;
+
+    std::vector<std::unique_ptr<Loop>> loops_;
+    std::atomic<unsigned> next_loop_{0};
+
+    void dispatch(const std::string& server_ip, int port, Request&& req);
+};
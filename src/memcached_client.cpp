@@ -1,35 +1,91 @@
 #include "memcached_client.hpp"
+#include "io_executor.hpp"
 #include <iostream>
 
-MemcachedClient::MemcachedClient() {}
+// how long a thread waits for a free handle when all pool_size are checked out
+static const time_t kCheckoutTimeoutSec = 5;
+
+MemcachedClient::MemcachedClient(size_t pool_size, int async_loops)
+    : pool_size_(pool_size > 0 ? pool_size : 1), async_loops_(async_loops), table_(nullptr) {
+    tables_.emplace_back(new ServerTable());
+    table_.store(tables_.back().get(), std::memory_order_release);
+}
 
 MemcachedClient::~MemcachedClient() {
-    for (auto& kv : server_map) {
-        memcached_free(kv.second);
+    // stop the event loops first: pending async requests fail with their callbacks
+    async_.reset();
+    for (memcached_pool_st* pool : pools_) memcached_free(memcached_pool_destroy(pool));
+}
+
+MemcachedClient::Lease::Lease(memcached_pool_st* pool) : pool_(pool) {
+    if (!pool_) return;
+
+    struct timespec timeout;
+    timeout.tv_sec = kCheckoutTimeoutSec;
+    timeout.tv_nsec = 0;
+    memcached_return rc;
+    memc_ = memcached_pool_fetch(pool_, &timeout, &rc);
+    if (!memc_) {
+        std::cerr << "Memcached pool checkout failed: " << memcached_strerror(NULL, rc) << std::endl;
     }
 }
 
-memcached_st* MemcachedClient::get_or_create_client(const std::string& server_ip, int port) {
+MemcachedClient::Lease::~Lease() {
+    if (memc_) memcached_pool_release(pool_, memc_);
+}
+
+memcached_pool_st* MemcachedClient::create_pool(const std::string& server_ip, int port) {
+    memcached_st* master = memcached_create(NULL);
+    if (!master) return nullptr;
+    memcached_server_add(master, server_ip.c_str(), port);
+
+    // handles are cloned from master; one is created up front, the rest on demand
+    memcached_pool_st* pool = memcached_pool_create(master, 1, (int)pool_size_);
+    if (!pool) memcached_free(master);
+    return pool;
+}
+
+memcached_pool_st* MemcachedClient::get_or_create_pool(const std::string& server_ip, int port) {
     std::string server_key = server_ip + ":" + std::to_string(port);
-    if (server_map.find(server_key) == server_map.end()) {
-        memcached_st* memc = memcached_create(NULL);
-        if (!memc) {
-            std::cerr << "Failed to create memcached client for " << server_key << std::endl;
-            return nullptr;
-        }
-        memcached_server_add(memc, server_ip.c_str(), port);
-        server_map[server_key] = memc;
+
+    // fast path: lock-free lookup in the current table
+    const ServerTable* table = table_.load(std::memory_order_acquire);
+    auto it = table->find(server_key);
+    if (it != table->end()) return it->second;
+
+    std::lock_guard<std::mutex> lock(create_mutex_);
+    table = table_.load(std::memory_order_acquire);
+    it = table->find(server_key);
+    if (it != table->end()) return it->second;
+
+    memcached_pool_st* pool = create_pool(server_ip, port);
+    if (!pool) {
+        std::cerr << "Failed to create memcached pool for " << server_key << std::endl;
+        return nullptr;
     }
-    return server_map[server_key];
+
+    // publish a new table containing the new server
+    std::unique_ptr<ServerTable> next(new ServerTable(*table));
+    (*next)[server_key] = pool;
+    pools_.push_back(pool);
+    tables_.push_back(std::move(next));
+    table_.store(tables_.back().get(), std::memory_order_release);
+    return pool;
 }
 
 bool MemcachedClient::set(const std::string& server_ip, int port,
                           const std::string& key, const std::string& value) {
-    memcached_st* memc = get_or_create_client(server_ip, port);
+    return set(server_ip, port, key, value.data(), value.size());
+}
+
+bool MemcachedClient::set(const std::string& server_ip, int port,
+                          const std::string& key, const char* value, size_t value_len) {
+    Lease lease(get_or_create_pool(server_ip, port));
+    memcached_st* memc = lease.get();
     if (!memc) return false;
 
     memcached_return rc = memcached_set(memc, key.c_str(), key.length(),
-                                        value.c_str(), value.length(),
+                                        value, value_len,
                                         (time_t)0, 0);
     if (rc != MEMCACHED_SUCCESS) {
         std::cerr << "Memcached SET failed on " << server_ip << ":" << port
@@ -40,7 +96,8 @@ bool MemcachedClient::set(const std::string& server_ip, int port,
 
 bool MemcachedClient::get(const std::string& server_ip, int port,
                           const std::string& key, std::string& value_out) {
-    memcached_st* memc = get_or_create_client(server_ip, port);
+    Lease lease(get_or_create_pool(server_ip, port));
+    memcached_st* memc = lease.get();
     if (!memc) return false;
 
     size_t value_length;
@@ -58,3 +115,134 @@ bool MemcachedClient::get(const std::string& server_ip, int port,
         return false;
     }
 }
+
+bool MemcachedClient::mget(const std::string& server_ip, int port,
+                           const std::vector<std::string>& keys,
+                           std::unordered_map<std::string, std::string>& values_out) {
+    if (keys.empty()) return true;
+    Lease lease(get_or_create_pool(server_ip, port));
+    memcached_st* memc = lease.get();
+    if (!memc) return false;
+
+    std::vector<const char*> key_ptrs;
+    std::vector<size_t> key_lens;
+    key_ptrs.reserve(keys.size());
+    key_lens.reserve(keys.size());
+    for (const auto& key : keys) {
+        key_ptrs.push_back(key.c_str());
+        key_lens.push_back(key.length());
+    }
+
+    memcached_return rc = memcached_mget(memc, key_ptrs.data(), key_lens.data(), keys.size());
+    if (rc != MEMCACHED_SUCCESS) {
+        std::cerr << "Memcached MGET failed on " << server_ip << ":" << port
+                  << " (" << keys.size() << " keys): " << memcached_strerror(memc, rc) << std::endl;
+        return false;
+    }
+
+    // drain all results, otherwise the connection is left in an undefined state
+    size_t found = 0;
+    memcached_result_st* result;
+    while ((result = memcached_fetch_result(memc, NULL, &rc)) != NULL) {
+        std::string key(memcached_result_key_value(result), memcached_result_key_length(result));
+        values_out[key].assign(memcached_result_value(result), memcached_result_length(result));
+        memcached_result_free(result);
+        found++;
+    }
+
+    if (found != keys.size()) {
+        std::cerr << "Memcached MGET on " << server_ip << ":" << port
+                  << " returned " << found << " / " << keys.size() << " keys" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MemcachedClient::mset(const std::string& server_ip, int port,
+                           const std::vector<std::string>& keys,
+                           const std::vector<MemcachedValue>& values) {
+    if (keys.size() != values.size()) return false;
+    if (keys.empty()) return true;
+
+    // libmemcached only pipelines sets with NOREPLY, where a rejected key
+    // (e.g. larger than the item size limit) is silently dropped. The binary
+    // SETs of the async transport are pipelined and each one is answered.
+    CompletionQueue<std::pair<size_t, bool>> done;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        set_async(server_ip, port, keys[i], values[i].data, values[i].len,
+                  [&done, i](bool ok) { done.push(std::make_pair(i, ok)); });
+    }
+
+    bool ok = true;
+    for (size_t n = 0; n < keys.size(); ++n) {
+        std::pair<size_t, bool> r = done.pop();
+        if (!r.second) {
+            std::cerr << "Memcached MSET failed on " << server_ip << ":" << port
+                      << " for key=" << keys[r.first] << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+MemcachedAsyncEngine& MemcachedClient::async_engine() {
+    std::call_once(async_once_, [this]() {
+        async_.reset(new MemcachedAsyncEngine(async_loops_));
+    });
+    return *async_;
+}
+
+void MemcachedClient::get_async(const std::string& server_ip, int port,
+                                const std::string& key, AsyncGetCallback cb) {
+    async_engine().get(server_ip, port, key, std::move(cb));
+}
+
+std::future<AsyncGetResult> MemcachedClient::get_async(const std::string& server_ip, int port,
+                                                       const std::string& key) {
+    auto promise = std::make_shared<std::promise<AsyncGetResult>>();
+    std::future<AsyncGetResult> fut = promise->get_future();
+    get_async(server_ip, port, key, [promise](AsyncGetResult r) {
+        promise->set_value(std::move(r));
+    });
+    return fut;
+}
+
+void MemcachedClient::get_into_async(const std::string& server_ip, int port,
+                                     const std::string& key, uint8_t* dst, size_t capacity,
+                                     AsyncGetIntoCallback cb) {
+    async_engine().get_into(server_ip, port, key, dst, capacity, std::move(cb));
+}
+
+bool MemcachedClient::get_into(const std::string& server_ip, int port,
+                               const std::string& key, uint8_t* dst, size_t capacity,
+                               size_t& len_out) {
+    auto promise = std::make_shared<std::promise<std::pair<bool, size_t>>>();
+    std::future<std::pair<bool, size_t>> fut = promise->get_future();
+    get_into_async(server_ip, port, key, dst, capacity, [promise](bool ok, size_t len) {
+        promise->set_value(std::make_pair(ok, len));
+    });
+    std::pair<bool, size_t> r = fut.get();
+    len_out = r.second;
+    return r.first;
+}
+
+void MemcachedClient::set_async(const std::string& server_ip, int port,
+                                const std::string& key, std::string value, AsyncSetCallback cb) {
+    async_engine().set(server_ip, port, key, std::move(value), std::move(cb));
+}
+
+void MemcachedClient::set_async(const std::string& server_ip, int port,
+                                const std::string& key, const char* value, size_t value_len,
+                                AsyncSetCallback cb) {
+    async_engine().set(server_ip, port, key, value, value_len, std::move(cb));
+}
+
+std::future<bool> MemcachedClient::set_async(const std::string& server_ip, int port,
+                                             const std::string& key, std::string value) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> fut = promise->get_future();
+    set_async(server_ip, port, key, std::move(value), [promise](bool ok) {
+        promise->set_value(ok);
+    });
+    return fut;
+}
@@ -2,23 +2,123 @@
 //memcached_client.hpp
 #pragma once
 #include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <future>
 #include <unordered_map>
 #include <libmemcached/memcached.h>
+#include <libmemcached/util.h>
 
+#include "memcached_async.hpp"
+
+// raw value for mset (not owned)
+struct MemcachedValue {
+    const char* data;
+    size_t len;
+};
+
+// Thread-safe client. Every server gets a memcached_pool_st of up to pool_size
+// handles; each call checks out one handle for the calling thread and returns
+// it afterwards, so concurrent repair fetches never share a connection.
+// The server -> pool table is copy-on-write: lookups are a single atomic load,
+// only the first access to a new server takes the mutex.
 class MemcachedClient {
 private:
-    std::unordered_map<std::string, memcached_st*> server_map;
+    typedef std::unordered_map<std::string, memcached_pool_st*> ServerTable;
+
+    // RAII checkout of one handle
+    class Lease {
+    public:
+        explicit Lease(memcached_pool_st* pool);
+        ~Lease();
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        memcached_st* get() const { return memc_; }
+    private:
+        memcached_pool_st* pool_ = nullptr;
+        memcached_st* memc_ = nullptr;
+    };
 
-    memcached_st* get_or_create_client(const std::string& server_ip, int port);
+    size_t pool_size_;
+    int async_loops_;
+    std::once_flag async_once_;
+    std::unique_ptr<MemcachedAsyncEngine> async_;
+    std::atomic<const ServerTable*> table_;
+    std::mutex create_mutex_;
+    std::vector<memcached_pool_st*> pools_;
+    // every published table; old ones are kept until destruction because readers
+    // may still hold them (one table per distinct server, so this stays small)
+    std::vector<std::unique_ptr<const ServerTable>> tables_;
+
+    memcached_pool_st* get_or_create_pool(const std::string& server_ip, int port);
+    memcached_pool_st* create_pool(const std::string& server_ip, int port);
+    MemcachedAsyncEngine& async_engine();
 
 public:
-    MemcachedClient();
+    static constexpr size_t kDefaultPoolSize = 8;
+
+    // pool_size: max connections per server (= max concurrent requests to it)
+    // async_loops: event loop threads of the async transport, created on the
+    //              first get_async/set_async (<= 0 -> one per core)
+    explicit MemcachedClient(size_t pool_size = kDefaultPoolSize, int async_loops = 0);
     ~MemcachedClient();
 
+    MemcachedClient(const MemcachedClient&) = delete;
+    MemcachedClient& operator=(const MemcachedClient&) = delete;
+
+    size_t pool_size() const { return pool_size_; }
+
     bool set(const std::string& server_ip, int port,
              const std::string& key, const std::string& value);
 
+    // raw-buffer variant: value bytes go to libmemcached without a std::string copy
+    bool set(const std::string& server_ip, int port,
+             const std::string& key, const char* value, size_t value_len);
+
     bool get(const std::string& server_ip, int port,
              const std::string& key, std::string& value_out);
+
+    // one round trip for all keys on one server (memcached_mget + fetch_result).
+    // found values are stored in values_out[key]; returns true only if every key was found
+    bool mget(const std::string& server_ip, int port,
+              const std::vector<std::string>& keys,
+              std::unordered_map<std::string, std::string>& values_out);
+
+    // pipelined set of keys[i] = values[i] on one server over the async
+    // transport: all requests are sent back to back, then every reply is
+    // awaited. Returns true only if the server acknowledged every key.
+    // values must stay valid until mset returns.
+    bool mset(const std::string& server_ip, int port,
+              const std::vector<std::string>& keys,
+              const std::vector<MemcachedValue>& values);
+
+    // Asynchronous transport: binary protocol over non-blocking sockets driven
+    // by epoll loops (see MemcachedAsyncEngine), independent of the libmemcached
+    // pools above. Callbacks run on a loop thread and must not block.
+    void get_async(const std::string& server_ip, int port,
+                   const std::string& key, AsyncGetCallback cb);
+    std::future<AsyncGetResult> get_async(const std::string& server_ip, int port,
+                                          const std::string& key);
+
+    // GET straight into a caller-owned buffer (e.g. a decode arena slot):
+    // value bytes go from the socket to dst without a std::string in between
+    void get_into_async(const std::string& server_ip, int port,
+                        const std::string& key, uint8_t* dst, size_t capacity,
+                        AsyncGetIntoCallback cb);
+    // blocking form; len_out receives the value length
+    bool get_into(const std::string& server_ip, int port,
+                  const std::string& key, uint8_t* dst, size_t capacity,
+                  size_t& len_out);
+
+    void set_async(const std::string& server_ip, int port,
+                   const std::string& key, std::string value, AsyncSetCallback cb);
+    // raw-buffer variant: value must stay valid until the callback ran
+    void set_async(const std::string& server_ip, int port,
+                   const std::string& key, const char* value, size_t value_len,
+                   AsyncSetCallback cb);
+    std::future<bool> set_async(const std::string& server_ip, int port,
+                                const std::string& key, std::string value);
 };
 
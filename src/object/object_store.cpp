@@ -0,0 +1,311 @@
+#include "object_store.hpp"
+#include "encoder.hpp"
+#include "stripe_slab.hpp"
+#include "memcached_client.hpp"
+#include "io_executor.hpp"
+#include "chunk_format.hpp"
+#include "chunked_stripe.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// memcached key 上限 250 字节；留出 ":<stripe>:<block_id>#<chunk>" 的余量
+static const size_t kMaxObjectIdLength = 200;
+
+static bool valid_object_id(const std::string& object_id)
+{
+    if (object_id.empty() || object_id.size() > kMaxObjectIdLength) return false;
+    for (unsigned char ch : object_id) {
+        if (ch <= 0x20 || ch == 0x7f) return false;   // memcached 文本协议不允许空白 / 控制字符
+    }
+    return true;
+}
+
+ObjectStore::ObjectStore(Encoder& encoder, const Placement& base, MemcachedClient& client,
+                         uint32_t block_size)
+    : encoder_(encoder), base_(base), client_(client), block_size_(block_size),
+      io_(&IoExecutor::shared()),
+      index_(base.k1(), base.m1(), base.k2()),
+      repair_(base.k1(), base.m1(), base.k2(), base.m2())
+{
+    repair_.set_strategy(base.strategy());
+    repair_.set_block_size(block_size);
+}
+
+void ObjectStore::set_io_executor(IoExecutor* io)
+{
+    io_ = io ? io : &IoExecutor::shared();
+    base_.set_io_executor(io_);
+    repair_.set_io_executor(io_);
+}
+
+Placement ObjectStore::stripe_placement(const std::string& object_id, const ObjectMeta& meta,
+                                        uint32_t stripe) const
+{
+    const uint64_t seq = meta.first_stripe + stripe;
+    return base_.rotated(seq, StripeIndex::stripe_prefix(object_id, seq));
+}
+
+// ---------------------------------------------------------
+// 写入：条带 s 编码进 slabs[s % W]，随即异步写出；复用 slab 前先等它
+// 上一个条带（s - W）的写入完成，所以最多 W 个条带同时在途
+// ---------------------------------------------------------
+bool ObjectStore::put(const std::string& object_id, const uint8_t* data, size_t len)
+{
+    if (!valid_object_id(object_id)) {
+        std::cerr << "[ObjectStore] Invalid object id '" << object_id << "'\n";
+        return false;
+    }
+
+    const int k1 = base_.k1(), m1 = base_.m1(), k2 = base_.k2(), m2 = base_.m2();
+    ObjectMeta meta = index_.allocate(len, block_size_);
+    meta.chunk_size = chunk_size_;
+    const uint64_t per_stripe = index_.stripe_data_bytes(meta);
+
+    if (chunk_size_ > 0) {
+        // 分块格式：每个条带由 ChunkedStripeWriter 按 chunk 流水线编码写入
+        int written = 0, expected = 0;
+        for (uint32_t s = 0; s < meta.stripe_count; ++s) {
+            std::vector<BlockView> spans(k1 * k2);
+            for (int i = 0; i < k1 * k2; ++i) {
+                uint64_t begin = (uint64_t)s * per_stripe + (uint64_t)i * block_size_;
+                if (begin < len)
+                    spans[i] = BlockView{data + begin, (size_t)std::min<uint64_t>(block_size_, len - begin)};
+            }
+            Placement pl = stripe_placement(object_id, meta, s);
+            ChunkedStripeWriter writer(encoder_, pl, client_, chunk_size_);
+            written += writer.write(spans, k1, m1, k2, m2, block_size_);
+            expected += (k1 + m1) * (k2 + m2);
+        }
+        std::cout << "[ObjectStore] Wrote object " << object_id << ": " << meta.stripe_count
+                  << " chunked stripes, " << written << " / " << expected << " blocks.\n";
+        if (written != expected) return false;
+        index_.insert(object_id, meta);
+        return true;
+    }
+
+    const size_t window = (size_t)stripes_in_flight_;
+    std::vector<StripeSlab> slabs(window);
+    std::vector<PendingWrite> pending(window);
+    std::vector<int> failed;
+    size_t expected = 0, written = 0;
+
+    for (uint32_t s = 0; s < meta.stripe_count; ++s) {
+        size_t slot = s % window;
+        if (pending[slot].done) written += base_.wait_writes(pending[slot], &failed);
+
+        const uint8_t* stripe_data = data ? data + (size_t)s * per_stripe : nullptr;
+        size_t stripe_len = (size_t)index_.stripe_length(meta, s);
+        std::vector<BlockView> views = encoder_.encode(stripe_data, stripe_len,
+                                                       k1, m1, k2, m2, (int)block_size_, slabs[slot]);
+        // 写任务在提交时已拿到 key 和 value，视图 Placement 不必存活到写完
+        pending[slot] = stripe_placement(object_id, meta, s).write_views_async(views, "", client_);
+        expected += views.size();
+    }
+    for (PendingWrite& w : pending) {
+        if (w.done) written += base_.wait_writes(w, &failed);
+    }
+
+    std::cout << "[ObjectStore] Wrote object " << object_id << ": " << meta.stripe_count
+              << " stripes, " << written << " / " << expected << " blocks.\n";
+    if (written != expected) return false;
+
+    index_.insert(object_id, meta);
+    return true;
+}
+
+// ---------------------------------------------------------
+// 读取：区间按块切成片段，每轮取 W 个条带，每个 server 一个 mget 任务，
+// 读到的块直接把片段拷到 out 的对应位置（位置互不重叠，任务间无需同步）。
+// 分块存储时只读覆盖片段的 chunk。某个 mget 报告读不到的块立即开始降级重建，
+// 多个重建并发执行，同样只读 / 只解码片段所在的区间
+// ---------------------------------------------------------
+bool ObjectStore::read(const std::string& object_id, uint64_t offset, size_t len, std::string& out)
+{
+    ObjectMeta meta;
+    if (!index_.find(object_id, meta)) {
+        std::cerr << "[ObjectStore] No such object " << object_id << "\n";
+        return false;
+    }
+    if (offset > meta.size) return false;
+    len = (size_t)std::min<uint64_t>(len, meta.size - offset);
+    out.assign(len, '\0');
+    char* dst = len > 0 ? &out[0] : nullptr;
+
+    // 一个数据块上的片段：块内 [block_off, block_off + len) -> out[out_off, ...)
+    struct Piece {
+        uint32_t stripe;
+        int block_id;
+        size_t block_off;
+        size_t len;
+        size_t out_off;
+    };
+    std::vector<Piece> pieces;
+    for (uint64_t pos = offset; pos < offset + len; ) {
+        BlockLocation loc = index_.locate(meta, pos);
+        size_t n = (size_t)std::min<uint64_t>(meta.block_size - loc.offset, offset + len - pos);
+        pieces.push_back(Piece{loc.stripe, loc.block_id, loc.offset, n, (size_t)(pos - offset)});
+        pos += n;
+    }
+
+    // 片段对应的 memcached value：整块存储时为块本身，分块存储时为覆盖片段的各个 chunk
+    struct Segment {
+        size_t piece;
+        std::string key_suffix;
+        size_t value_len;   // value 应有的长度
+        size_t src_off;     // 在 value 中的偏移
+        size_t len;
+        size_t out_off;
+    };
+    ChunkHeader layout;   // 分块存储时的 chunk 布局
+    layout.block_size = meta.block_size;
+    layout.chunk_size = meta.chunk_size;
+    auto segments_of = [&meta, &pieces, &layout](size_t p) {
+        const Piece& piece = pieces[p];
+        std::vector<Segment> segs;
+        if (meta.chunk_size == 0) {
+            segs.push_back(Segment{p, "", meta.block_size, piece.block_off, piece.len, piece.out_off});
+            return segs;
+        }
+        const size_t end = piece.block_off + piece.len;
+        for (int c = (int)(piece.block_off / meta.chunk_size); layout.chunk_offset(c) < end; ++c) {
+            size_t begin = std::max(piece.block_off, layout.chunk_offset(c));
+            size_t stop = std::min(end, layout.chunk_offset(c) + layout.chunk_length(c));
+            segs.push_back(Segment{p, chunk_suffix(c), layout.chunk_length(c),
+                                   begin - layout.chunk_offset(c), stop - begin,
+                                   piece.out_off + (begin - piece.block_off)});
+        }
+        return segs;
+    };
+
+    // ---- 降级重建：某个 mget 报告块读不到时立即排队，与其余 mget 及其它重建并发 ----
+    // read_degraded 内部要等待 IoExecutor 上的读取，不能作为 I/O 任务运行，
+    // 所以由按需启动的线程执行，最多 stripes_in_flight_ 个
+    std::mutex degraded_mtx;
+    std::condition_variable degraded_cv;
+    std::deque<size_t> degraded;   // 待重建的片段下标
+    std::unordered_map<uint32_t, std::unordered_set<int>> missing_by_stripe;   // 已知读不到的块
+    bool all_reported = false;
+    std::atomic<bool> ok{true};
+    std::vector<std::thread> rebuilders;
+
+    auto rebuild = [&]() {
+        for (;;) {
+            size_t p;
+            std::unordered_set<int> unavailable;
+            {
+                std::unique_lock<std::mutex> lock(degraded_mtx);
+                degraded_cv.wait(lock, [&]() { return !degraded.empty() || all_reported; });
+                if (degraded.empty()) return;
+                p = degraded.front();
+                degraded.pop_front();
+                unavailable = missing_by_stripe[pieces[p].stripe];
+            }
+            const Piece& piece = pieces[p];
+            Placement pl = stripe_placement(object_id, meta, piece.stripe);
+            std::string part;
+            if (!repair_.read_degraded(piece.block_id, piece.block_off, piece.len,
+                                       unavailable, pl, client_, part,
+                                       meta.chunk_size > 0 ? &layout : nullptr)) {
+                ok = false;
+                continue;
+            }
+            memcpy(dst + piece.out_off, part.data(), piece.len);
+        }
+    };
+    // 登记读不到的片段并排入重建队列
+    auto report_missing = [&](const std::vector<size_t>& missing) {
+        if (missing.empty()) return;
+        std::lock_guard<std::mutex> lock(degraded_mtx);
+        for (size_t p : missing) {
+            missing_by_stripe[pieces[p].stripe].insert(pieces[p].block_id);
+            degraded.push_back(p);
+        }
+        size_t want = std::min(degraded.size(), (size_t)stripes_in_flight_);
+        while (rebuilders.size() < want) rebuilders.emplace_back(rebuild);
+        degraded_cv.notify_all();
+    };
+
+    size_t next = 0;
+    while (next < pieces.size()) {
+        const uint32_t first_stripe = pieces[next].stripe;
+        CompletionQueue<std::vector<size_t>> done;   // 每个 mget 读不到的片段
+        size_t tasks = 0;
+
+        while (next < pieces.size() && pieces[next].stripe < first_stripe + (uint32_t)stripes_in_flight_) {
+            const uint32_t s = pieces[next].stripe;
+            std::unordered_map<int, size_t> piece_of;   // block_id -> 片段下标
+            std::vector<int> ids;
+            for (; next < pieces.size() && pieces[next].stripe == s; ++next) {
+                piece_of[pieces[next].block_id] = next;
+                ids.push_back(pieces[next].block_id);
+            }
+
+            Placement pl = stripe_placement(object_id, meta, s);
+            for (ServerBatch& batch : pl.group_by_server(ids)) {
+                std::vector<std::string> keys;
+                std::vector<Segment> targets;
+                for (int bid : batch.block_ids) {
+                    for (const Segment& seg : segments_of(piece_of[bid])) {
+                        keys.push_back(pl.block_key(bid) + seg.key_suffix);
+                        targets.push_back(seg);
+                    }
+                    piece_of.erase(bid);
+                }
+                io_->submit(done, [this, dst, ip = batch.ip, port = batch.port,
+                                   keys = std::move(keys), targets = std::move(targets)]() {
+                    std::unordered_map<std::string, std::string> values;
+                    client_.mget(ip, port, keys, values);
+                    std::vector<size_t> missing;
+                    for (size_t i = 0; i < keys.size(); ++i) {
+                        const Segment& seg = targets[i];
+                        auto it = values.find(keys[i]);
+                        if (it == values.end() || it->second.size() != seg.value_len) {
+                            if (missing.empty() || missing.back() != seg.piece)
+                                missing.push_back(seg.piece);
+                            continue;
+                        }
+                        memcpy(dst + seg.out_off, it->second.data() + seg.src_off, seg.len);
+                    }
+                    return missing;
+                });
+                ++tasks;
+            }
+            // piece_of 中剩下的块没有映射，同样按丢失处理
+            std::vector<size_t> unmapped;
+            for (const auto& kv : piece_of) unmapped.push_back(kv.second);
+            report_missing(unmapped);
+        }
+
+        for (size_t i = 0; i < tasks; ++i) report_missing(done.pop());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(degraded_mtx);
+        all_reported = true;
+        degraded_cv.notify_all();
+    }
+    for (std::thread& th : rebuilders) th.join();
+
+    if (!ok) std::cerr << "[ObjectStore] Failed to read object " << object_id << "\n";
+    return ok;
+}
+
+bool ObjectStore::get(const std::string& object_id, std::string& out)
+{
+    ObjectMeta meta;
+    if (!index_.find(object_id, meta)) {
+        std::cerr << "[ObjectStore] No such object " << object_id << "\n";
+        return false;
+    }
+    return read(object_id, 0, (size_t)meta.size, out);
+}
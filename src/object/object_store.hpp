@@ -0,0 +1,81 @@
+#pragma once
+
+#include "stripe_index.hpp"
+#include "placement.hpp"
+#include "repair.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Encoder;
+class MemcachedClient;
+class IoExecutor;
+
+// ---------------------------------------------------------
+// 多条带对象存储
+//
+// 对象按 k1 * k2 * block_size 字节切成条带，每个条带独立编码成一个 PC 网格。
+// 条带 s 的块写到 base.rotated(first_stripe + s, "<object>:<first_stripe + s>:") 上：
+// key 为 "<object>:<全局条带序号>:<block_id>"，placement 按全局条带序号轮转，
+// 连续条带的负载分散到不同 rack / server，而不是总压在同一组 server_index 上。
+// 最多 stripes_in_flight 个条带同时在途（写：编码下一个条带时前面的条带仍在写）
+// ---------------------------------------------------------
+class ObjectStore {
+public:
+    static constexpr int kDefaultStripesInFlight = 8;
+
+    // base: 已 generate_mapping 的 Placement，只作为轮转的模板
+    ObjectStore(Encoder& encoder, const Placement& base, MemcachedClient& client,
+                uint32_t block_size);
+
+    void set_stripes_in_flight(int n) { stripes_in_flight_ = n > 0 ? n : 1; }
+    int stripes_in_flight() const { return stripes_in_flight_; }
+
+    // chunk_size > 0：之后写入的对象按分块格式存储（chunk_format.hpp），
+    // 读取和降级重建都只读覆盖请求区间的 chunk；0（默认）为整块存储
+    void set_chunk_size(uint32_t chunk_size) { chunk_size_ = chunk_size; }
+    uint32_t chunk_size() const { return chunk_size_; }
+
+    // 条带读写使用的 I/O executor，默认 IoExecutor::shared()
+    void set_io_executor(IoExecutor* io);
+
+    // 写入对象（覆盖同名对象）。新条带使用新分配的全局序号和 key，
+    // 全部块写成功后才替换索引项，之前读到的仍是旧对象；失败时索引不变。
+    // 被替换的旧条带的 key 不删除，留给 memcached 的 LRU 淘汰
+    bool put(const std::string& object_id, const uint8_t* data, size_t len);
+    bool put(const std::string& object_id, const std::string& data) {
+        return put(object_id, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    // 读取对象的 [offset, offset + len)（超出对象末尾的部分截掉）。
+    // 直接读覆盖该区间的数据块；读不到的块由 Repair::read_degraded 在线重建，
+    // 只重建请求的字节区间，不写回。对象不存在或无法重建时返回 false
+    bool read(const std::string& object_id, uint64_t offset, size_t len, std::string& out);
+
+    // 读取整个对象
+    bool get(const std::string& object_id, std::string& out);
+
+    bool stat(const std::string& object_id, ObjectMeta& out) const { return index_.find(object_id, out); }
+
+    // 条带 stripe 的放置视图（轮转 + key 前缀），可直接交给 Repair
+    Placement stripe_placement(const std::string& object_id, const ObjectMeta& meta,
+                               uint32_t stripe) const;
+
+    const StripeIndex& index() const { return index_; }
+    const Placement& base_placement() const { return base_; }
+    // 降级读使用的 Repair（可设置修复方式、读取统计流量）
+    Repair& repair() { return repair_; }
+    uint32_t block_size() const { return block_size_; }
+
+private:
+    Encoder& encoder_;
+    Placement base_;
+    MemcachedClient& client_;
+    uint32_t block_size_;
+    uint32_t chunk_size_ = 0;
+    int stripes_in_flight_ = kDefaultStripesInFlight;
+    IoExecutor* io_;
+    StripeIndex index_;
+    Repair repair_;
+};
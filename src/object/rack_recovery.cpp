@@ -0,0 +1,178 @@
+#include "rack_recovery.hpp"
+#include "memcached_client.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+RackRecovery::RackRecovery(ObjectStore& store, MemcachedClient& client)
+    : store_(store), client_(client),
+      repair_(store.base_placement().k1(), store.base_placement().m1(),
+              store.base_placement().k2(), store.base_placement().m2()),
+      chunked_repair_(store.base_placement().k1(), store.base_placement().m1(),
+                      store.base_placement().k2(), store.base_placement().m2())
+{
+    repair_.set_strategy(store.base_placement().strategy());
+    repair_.set_block_size(store.block_size());
+    chunked_repair_.set_strategy(store.base_placement().strategy());
+    chunked_repair_.set_chunked(true);
+}
+
+namespace {
+
+// 一个待修条带
+struct StripeTask {
+    Placement placement;
+    bool chunked;
+    StripeRepairJob job;
+    std::vector<std::pair<std::string, int>> server_reads;   // (ip:port, 读取块数)
+    std::vector<std::pair<int, int>> rack_reads;              // (rack, 读取块数)
+};
+
+} // namespace
+
+RackRecoveryReport RackRecovery::recover_rack(int rack)
+{
+    RackRecoveryReport report;
+    report.rack = rack;
+    const Placement& base = store_.base_placement();
+    const int total = (base.k1() + base.m1()) * (base.k2() + base.m2());
+
+    // ---- 1. 枚举受影响的条带并逐条带规划 ----
+    std::vector<std::pair<std::string, ObjectMeta>> objects;
+    store_.index().for_each([&objects](const std::string& id, const ObjectMeta& meta) {
+        objects.emplace_back(id, meta);
+    });
+
+    std::vector<StripeTask> tasks;
+    for (const auto& obj : objects) {
+        const ObjectMeta& meta = obj.second;
+        for (uint32_t s = 0; s < meta.stripe_count; ++s) {
+            Placement pl = store_.stripe_placement(obj.first, meta, s);
+            std::unordered_set<int> failed;
+            for (int bid = 0; bid < total; ++bid) {
+                if (pl.get(bid).rack == rack) failed.insert(bid);
+            }
+            if (failed.empty()) continue;
+
+            ++report.stripes_affected;
+            report.blocks_lost += failed.size();
+
+            StripeTask task{pl, meta.chunk_size > 0, StripeRepairJob(), {}, {}};
+            Repair& repair = task.chunked ? chunked_repair_ : repair_;
+            if (!repair.prepare_stripe_repair(failed, pl, task.job)) {
+                std::cerr << "[RackRecovery] Stripe " << obj.first << ":" << s
+                          << " is not recoverable (" << failed.size() << " blocks lost)\n";
+                ++report.stripes_failed;
+                continue;
+            }
+            for (const ServerBatch& batch : pl.group_by_server(task.job.reads))
+                task.server_reads.emplace_back(batch.ip + ":" + std::to_string(batch.port),
+                                               (int)batch.block_ids.size());
+            // 同一地址的 batch 可能跨 rack（单机部署），rack 负载按块统计
+            std::map<int, int> rack_reads;
+            for (int bid : task.job.reads) rack_reads[pl.get(bid).rack]++;
+            task.rack_reads.assign(rack_reads.begin(), rack_reads.end());
+            tasks.push_back(std::move(task));
+        }
+    }
+
+    // ---- 2. 调度执行 ----
+    std::mutex mutex;
+    std::vector<size_t> pending(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) pending[i] = i;
+    std::unordered_map<std::string, int> server_load;   // 正在读取的块数
+    std::unordered_map<int, int> rack_load;
+    const int servers_per_rack = std::max(1, base.servers_per_rack());
+
+    // 在持锁状态下取负载最轻的条带并登记其读取负载；没有待修条带时返回 false
+    auto pick = [&](size_t& out) {
+        if (pending.empty()) return false;
+        size_t window = std::min<size_t>(pending.size(), kScheduleWindow);
+        size_t best = 0;
+        long best_score = -1;
+        for (size_t i = 0; i < window; ++i) {
+            const StripeTask& t = tasks[pending[i]];
+            long score = 0;
+            for (const auto& sr : t.server_reads) {
+                auto it = server_load.find(sr.first);
+                if (it != server_load.end()) score += (long)it->second * sr.second;
+            }
+            for (const auto& rr : t.rack_reads) {
+                auto it = rack_load.find(rr.first);
+                if (it != rack_load.end()) score += (long)it->second * rr.second / servers_per_rack;
+            }
+            if (best_score < 0 || score < best_score) {
+                best = i;
+                best_score = score;
+                if (score == 0) break;
+            }
+        }
+        out = pending[best];
+        pending.erase(pending.begin() + best);
+        for (const auto& sr : tasks[out].server_reads) server_load[sr.first] += sr.second;
+        for (const auto& rr : tasks[out].rack_reads) rack_load[rr.first] += rr.second;
+        return true;
+    };
+
+    // 分块条带经 repair_and_set 重新规划并逐 chunk 读写，读写量只能取流量计数
+    const RepairTrafficStats before = repair_.traffic_stats();
+    const RepairTrafficStats chunked_before = chunked_repair_.traffic_stats();
+    auto t0 = std::chrono::high_resolution_clock::now();
+    auto worker = [&]() {
+        size_t idx;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!pick(idx)) return;
+            }
+            StripeTask& t = tasks[idx];
+            Repair& repair = t.chunked ? chunked_repair_ : repair_;
+            bool ok = repair.execute_stripe_repair(t.job, t.placement, client_);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& sr : t.server_reads) server_load[sr.first] -= sr.second;
+            for (const auto& rr : t.rack_reads) rack_load[rr.first] -= rr.second;
+            report.naive_reads += t.job.naive_reads;
+            if (ok) {
+                report.blocks_repaired += t.job.failed.size();
+            } else {
+                ++report.stripes_failed;
+            }
+        }
+    };
+
+    // 工作线程不能是 IoExecutor 任务：条带修复内部的读写会等待 IoExecutor 上的任务
+    std::vector<std::thread> workers;
+    int n = (int)std::min<size_t>(tasks.size(), (size_t)stripes_in_flight_);
+    for (int i = 0; i < n; ++i) workers.emplace_back(worker);
+    for (std::thread& th : workers) th.join();
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    // ---- 3. 汇总 ----
+    const RepairTrafficStats after = repair_.traffic_stats();
+    const RepairTrafficStats chunked_after = chunked_repair_.traffic_stats();
+    report.blocks_read = (size_t)(after.blocks_read - before.blocks_read +
+                                  chunked_after.blocks_read - chunked_before.blocks_read);
+    report.bytes_read = after.bytes_read - before.bytes_read +
+                        chunked_after.bytes_read - chunked_before.bytes_read;
+    report.bytes_written = after.bytes_written - before.bytes_written +
+                           chunked_after.bytes_written - chunked_before.bytes_written;
+    report.seconds = std::chrono::duration<double>(t1 - t0).count();
+    if (report.seconds > 0)
+        report.throughput_mbps = report.bytes_written / (1024.0 * 1024.0) / report.seconds;
+
+    std::cout << "[RackRecovery] Rack " << rack << ": " << report.blocks_repaired << " / "
+              << report.blocks_lost << " blocks repaired in " << report.stripes_affected
+              << " stripes (" << report.stripes_failed << " failed), read "
+              << report.blocks_read << " blocks (" << report.naive_reads << " without dedup), "
+              << report.seconds * 1000 << " ms, " << report.throughput_mbps << " MB/s\n";
+    return report;
+}
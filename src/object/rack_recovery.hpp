@@ -0,0 +1,60 @@
+#pragma once
+
+#include "object_store.hpp"
+#include "repair.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+class MemcachedClient;
+
+// 一次整机架恢复的汇总
+struct RackRecoveryReport {
+    int rack = -1;
+    size_t stripes_affected = 0;   // 在该机架上有块的条带数
+    size_t stripes_failed = 0;     // 无法规划或执行失败的条带数
+    size_t blocks_lost = 0;
+    size_t blocks_repaired = 0;
+    size_t naive_reads = 0;        // 各修复步骤各自读取时的读取块数（按规划估算）
+    // 以下取自 Repair::traffic_stats() 的增量，即实际读写量（分块格式含头和全部 chunk，
+    // 块数按块头计）
+    size_t blocks_read = 0;
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+    double seconds = 0;
+    double throughput_mbps = 0;    // 修复字节数 / 耗时（MB/s）
+};
+
+// ---------------------------------------------------------
+// 整机架恢复
+//
+// 机架 R 故障 = 所有条带上 PlacementEntry.rack == R 的块同时丢失。
+// 1. 枚举：遍历 StripeIndex 的每个对象、每个条带，在该条带的放置视图上找出落在 R 的块；
+// 2. 规划：每个条带单独 Repair::prepare_stripe_repair，得到修复计划与去重后的读取集合；
+// 3. 调度：stripes_in_flight 个工作线程并发执行条带修复。每次从待修条带的前
+//    kScheduleWindow 个中取当前读取负载最轻的一个——负载为该条带要读的各 server
+//    （及其所在机架）上正在进行的读取块数之和——使读取尽量分散到各幸存机架 / server；
+// 4. 汇总：修复块数、实际读写量（Repair 的流量计数）、耗时与吞吐
+// ---------------------------------------------------------
+class RackRecovery {
+public:
+    static constexpr int kScheduleWindow = 64;
+
+    RackRecovery(ObjectStore& store, MemcachedClient& client);
+
+    void set_stripes_in_flight(int n) { stripes_in_flight_ = n > 0 ? n : 1; }
+    int stripes_in_flight() const { return stripes_in_flight_; }
+
+    // 整块存储的条带使用的 Repair（可设置规划器、读取流量统计）
+    Repair& repair() { return repair_; }
+
+    // 恢复机架 rack 上的全部块并写回原位置（机架恢复后或替换节点上线后调用）
+    RackRecoveryReport recover_rack(int rack);
+
+private:
+    ObjectStore& store_;
+    MemcachedClient& client_;
+    int stripes_in_flight_ = ObjectStore::kDefaultStripesInFlight;
+    Repair repair_;
+    Repair chunked_repair_;   // 分块格式的条带
+};
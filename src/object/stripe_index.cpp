@@ -0,0 +1,84 @@
+#include "stripe_index.hpp"
+
+#include <algorithm>
+
+StripeIndex::StripeIndex(int k1, int m1, int k2) : k1_(k1), m1_(m1), k2_(k2) {}
+
+ObjectMeta StripeIndex::allocate(uint64_t size, uint32_t block_size)
+{
+    ObjectMeta meta;
+    meta.size = size;
+    meta.block_size = block_size;
+    uint64_t per_stripe = stripe_data_bytes(meta);
+    // 空对象也占一个条带，读写路径无需特判
+    meta.stripe_count = per_stripe > 0 ? (uint32_t)std::max<uint64_t>(1, (size + per_stripe - 1) / per_stripe) : 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    meta.first_stripe = next_stripe_;
+    next_stripe_ += meta.stripe_count;
+    return meta;
+}
+
+void StripeIndex::insert(const std::string& object_id, const ObjectMeta& meta)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    objects_[object_id] = meta;
+}
+
+bool StripeIndex::find(const std::string& object_id, ObjectMeta& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = objects_.find(object_id);
+    if (it == objects_.end()) return false;
+    out = it->second;
+    return true;
+}
+
+bool StripeIndex::remove(const std::string& object_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return objects_.erase(object_id) > 0;
+}
+
+size_t StripeIndex::object_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return objects_.size();
+}
+
+void StripeIndex::for_each(const std::function<void(const std::string&, const ObjectMeta&)>& fn) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& kv : objects_) fn(kv.first, kv.second);
+}
+
+uint64_t StripeIndex::allocated_stripes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_stripe_;
+}
+
+uint64_t StripeIndex::stripe_length(const ObjectMeta& meta, uint32_t stripe) const
+{
+    uint64_t per_stripe = stripe_data_bytes(meta);
+    uint64_t begin = (uint64_t)stripe * per_stripe;
+    if (begin >= meta.size) return 0;
+    return std::min(per_stripe, meta.size - begin);
+}
+
+BlockLocation StripeIndex::locate(const ObjectMeta& meta, uint64_t offset) const
+{
+    BlockLocation loc;
+    uint64_t per_stripe = stripe_data_bytes(meta);
+    if (per_stripe == 0) return loc;
+    loc.stripe = (uint32_t)(offset / per_stripe);
+    uint64_t in_stripe = offset % per_stripe;
+    loc.block_id = data_block_id((int)(in_stripe / meta.block_size));
+    loc.offset = (uint32_t)(in_stripe % meta.block_size);
+    return loc;
+}
+
+std::string StripeIndex::stripe_prefix(const std::string& object_id, uint64_t stripe_seq)
+{
+    return object_id + ":" + std::to_string(stripe_seq) + ":";
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// 一个对象的元数据（32 字节）
+// 对象按 stripe_data_bytes = k1 * k2 * block_size 切成 stripe_count 个条带，
+// 条带 s 的全局序号为 first_stripe + s，决定它的 placement 轮转（Placement::rotated）
+struct ObjectMeta {
+    uint64_t size = 0;           // 对象字节数
+    uint64_t first_stripe = 0;   // 第一个条带的全局序号
+    uint32_t stripe_count = 0;
+    uint32_t block_size = 0;
+    uint32_t chunk_size = 0;     // > 0：块按分块格式存储（chunk_format.hpp）
+};
+
+// 对象内偏移 → 所在数据块
+struct BlockLocation {
+    uint32_t stripe = 0;   // 条带下标（对象内）
+    int block_id = 0;      // 条带内 block_id（D 区，行优先）
+    uint32_t offset = 0;   // 块内偏移
+};
+
+// ---------------------------------------------------------
+// 内存中的条带索引：object_id → ObjectMeta
+//
+// 每个对象只记录大小、起始全局条带序号、条带数与块大小，条带的 placement
+// 和 key 都由它们推出，不逐条带 / 逐块存表。全局条带序号单调分配，
+// 相邻条带（包括不同对象的条带）因此落在轮转后的不同 rack / server 上。
+// 线程安全
+// ---------------------------------------------------------
+class StripeIndex {
+public:
+    StripeIndex(int k1, int m1, int k2);
+
+    // 为 size 字节的对象分配 stripe_count 个连续的全局条带序号（尚未登记）
+    ObjectMeta allocate(uint64_t size, uint32_t block_size);
+    // 登记对象（已存在则覆盖）
+    void insert(const std::string& object_id, const ObjectMeta& meta);
+
+    bool find(const std::string& object_id, ObjectMeta& out) const;
+    bool remove(const std::string& object_id);
+
+    size_t object_count() const;
+
+    // 遍历全部对象（持锁调用 fn，fn 内不可再访问索引）
+    void for_each(const std::function<void(const std::string&, const ObjectMeta&)>& fn) const;
+    uint64_t allocated_stripes() const;
+
+    // 每个条带承载的对象字节数
+    uint64_t stripe_data_bytes(const ObjectMeta& meta) const {
+        return (uint64_t)k1_ * k2_ * meta.block_size;
+    }
+    // 条带 s 实际承载的字节数（最后一个条带可能不满）
+    uint64_t stripe_length(const ObjectMeta& meta, uint32_t stripe) const;
+
+    // 条带内第 i 个数据块的 block_id：与 Encoder 连续输入的顺序一致，
+    // 第 i 块为 D 区 (i / k1, i % k1)
+    int data_block_id(int i) const { return (i / k1_) * (k1_ + m1_) + i % k1_; }
+
+    // 对象内偏移 offset（< meta.size）所在的条带 / 数据块 / 块内偏移
+    BlockLocation locate(const ObjectMeta& meta, uint64_t offset) const;
+
+    // 条带的 key 前缀 "<object>:<全局条带序号>:"，完整 key 为前缀 + block_id。
+    // 用全局序号而非对象内下标：覆盖写同名对象时新条带的 key 与旧条带不同，
+    // 新对象写完登记之前旧对象仍可读
+    static std::string stripe_prefix(const std::string& object_id, uint64_t stripe_seq);
+
+private:
+    int k1_, m1_, k2_;
+    mutable std::mutex mutex_;
+    uint64_t next_stripe_ = 0;
+    std::unordered_map<std::string, ObjectMeta> objects_;
+};
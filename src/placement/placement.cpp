@@ -1,4 +1,10 @@
 #include "placement.hpp"
+#include "io_executor.hpp"
+
+#include <map>
+#include <algorithm>
+
+const char* const Placement::kDefaultKeyPrefix = "block_";
 
 // ---------------------------------------------------------
 // 构造函数
@@ -14,11 +20,17 @@ Placement::Placement(int k1, int m1, int k2, int m2,
       rack_count_(rack_count),
       servers_per_rack_(servers_per_rack),
       base_port_(base_port),
-      use_single_vm_(use_single_vm) 
+      use_single_vm_(use_single_vm),
+      io_(&IoExecutor::shared())
 {
     rack_ips_.resize(rack_count_);
 }
 
+void Placement::set_io_executor(IoExecutor* io)
+{
+    io_ = io ? io : &IoExecutor::shared();
+}
+
 // ---------------------------------------------------------
 // init：设置 rack IP，清理表
 // ---------------------------------------------------------
@@ -72,44 +84,212 @@ bool Placement::write_block(const PlacementEntry& e,
                             const std::string& data,
                             MemcachedClient& client)
 {
-    const std::string& ip = rack_ips_[e.rack];
-    int port = base_port_ + e.server_index;
+    const std::string& ip = server_ip(e);
+    int port = server_port(e);
 
-    std::string key = "block_" + std::to_string(e.block_id);
+    std::string key = block_key(e.block_id);
 
     return client.set(ip, port, key, data);
 }
 
+bool Placement::write_block(const PlacementEntry& e,
+                            const BlockView& data,
+                            MemcachedClient& client)
+{
+    const std::string& ip = server_ip(e);
+    int port = server_port(e);
+
+    std::string key = block_key(e.block_id);
+
+    return client.set(ip, port, key,
+                      reinterpret_cast<const char*>(data.data), data.len);
+}
+
 // ---------------------------------------------------------
-// 写入全部 block
+// 按 server 分组
 // ---------------------------------------------------------
-int Placement::write_all_blocks(
-    const std::unordered_map<int, std::string>& encoded_map,
-    MemcachedClient& client)
+std::vector<ServerBatch> Placement::group_by_server(const std::vector<int>& block_ids) const
 {
-    int success = 0;
+    // 按实际地址分组：单机部署时不同 rack 的同号 server 是同一个 memcached
+    std::map<std::pair<std::string, int>, size_t> index; // (ip, port) -> batch 下标
+    std::vector<ServerBatch> batches;
 
-    for (const auto& kv : encoded_map) {
-        int block_id = kv.first;
-        const std::string& data = kv.second;
+    for (int block_id : block_ids) {
+        auto it = placement_map_.find(block_id);
+        if (it == placement_map_.end()) continue;
+        const PlacementEntry& e = it->second;
+
+        auto key = std::make_pair(server_ip(e), server_port(e));
+        auto pos = index.find(key);
+        if (pos == index.end()) {
+            pos = index.emplace(key, batches.size()).first;
+            batches.push_back(ServerBatch{server_ip(e), server_port(e), {}});
+        }
+        batches[pos->second].block_ids.push_back(block_id);
+    }
+
+    std::vector<ServerBatch> sorted;
+    sorted.reserve(batches.size());
+    for (const auto& kv : index) sorted.push_back(std::move(batches[kv.second]));
+    return sorted;
+}
+
+// ---------------------------------------------------------
+// 并发写入：每个 server 一个 I/O 任务，各自按 max_inflight_ 个请求一组
+// 流水线 mset（连续发出、逐个确认），组与组之间串行，限制在途请求数。
+// 写入耗时约为最慢 server 的耗时，而非所有 block RTT 之和。
+// key / value 在提交时就构造好并由任务持有，value 指向的字节需保持有效直到 wait_writes
+// ---------------------------------------------------------
+PendingWrite Placement::submit_writes(std::vector<ServerBatch> batches,
+                                      const std::function<MemcachedValue(int)>& value_of,
+                                      const std::string& key_suffix,
+                                      MemcachedClient& client) const
+{
+    PendingWrite w;
+    w.batches = std::move(batches);
+    w.done = std::make_shared<CompletionQueue<PendingWrite::BatchResult>>();
+
+    for (size_t b = 0; b < w.batches.size(); ++b) {
+        const ServerBatch& batch = w.batches[b];
+        std::vector<std::string> keys;
+        std::vector<MemcachedValue> values;
+        for (int block_id : batch.block_ids) {
+            keys.push_back(block_key(block_id) + key_suffix);
+            values.push_back(value_of(block_id));
+        }
+
+        auto done = w.done;
+        size_t inflight = (size_t)max_inflight_;
+        io_->submit(*done, [&client, done, b, inflight, batch,
+                            keys = std::move(keys), values = std::move(values)]() {
+            std::vector<int> failed;
+            for (size_t begin = 0; begin < keys.size(); begin += inflight) {
+                size_t end = std::min(keys.size(), begin + inflight);
+                std::vector<std::string> group_keys(keys.begin() + begin, keys.begin() + end);
+                std::vector<MemcachedValue> group_values(values.begin() + begin, values.begin() + end);
+                if (!client.mset(batch.ip, batch.port, group_keys, group_values))
+                    failed.insert(failed.end(), batch.block_ids.begin() + begin,
+                                  batch.block_ids.begin() + end);
+            }
+            return PendingWrite::BatchResult(b, std::move(failed));
+        });
+    }
+    return w;
+}
+
+// 等待一组写入完成；结果按 batches 顺序汇总，输出与线程调度无关
+int Placement::wait_writes(PendingWrite& w, std::vector<int>* failed_out) const
+{
+    std::vector<std::vector<int>> failed_by_batch(w.batches.size());
+    for (size_t i = 0; i < w.batches.size(); ++i) {
+        PendingWrite::BatchResult r = w.done->pop();
+        failed_by_batch[r.first] = std::move(r.second);
+    }
+
+    int success = 0;
+    for (size_t b = 0; b < w.batches.size(); ++b) {
+        const std::vector<int>& failed = failed_by_batch[b];
+        success += (int)(w.batches[b].block_ids.size() - failed.size());
+        for (int block_id : failed) {
+            std::cerr << "[Placement] Write failed for block " << block_id
+                      << " on " << w.batches[b].ip << ":" << w.batches[b].port << "\n";
+            if (failed_out) failed_out->push_back(block_id);
+        }
+    }
+    w.batches.clear();
+    w.done.reset();
+    return success;
+}
 
+PendingWrite Placement::write_views_async(const std::vector<BlockView>& blocks,
+                                          const std::string& key_suffix,
+                                          MemcachedClient& client) const
+{
+    std::vector<int> ids;
+    ids.reserve(blocks.size());
+    for (int block_id = 0; block_id < (int)blocks.size(); ++block_id) {
+        if (blocks[block_id].data == nullptr) continue;   // 空视图：不写
         if (placement_map_.count(block_id) == 0) {
             std::cerr << "[Placement] Missing mapping for block " << block_id << "\n";
             continue;
         }
+        ids.push_back(block_id);
+    }
 
-        const PlacementEntry& e = placement_map_.at(block_id);
+    return submit_writes(group_by_server(ids), [&](int block_id) {
+        return MemcachedValue{reinterpret_cast<const char*>(blocks[block_id].data),
+                              blocks[block_id].len};
+    }, key_suffix, client);
+}
 
-        if (write_block(e, data, client))
-            success++;
+// ---------------------------------------------------------
+// 写入全部 block：按 server 分组并发写入
+// ---------------------------------------------------------
+int Placement::write_all_blocks(
+    const std::unordered_map<int, std::string>& encoded_map,
+    MemcachedClient& client)
+{
+    std::vector<int> ids;
+    ids.reserve(encoded_map.size());
+    for (const auto& kv : encoded_map) {
+        if (placement_map_.count(kv.first) == 0) {
+            std::cerr << "[Placement] Missing mapping for block " << kv.first << "\n";
+            continue;
+        }
+        ids.push_back(kv.first);
     }
 
+    // 按 block_id 排序，使分组与写入顺序确定
+    std::sort(ids.begin(), ids.end());
+    PendingWrite w = submit_writes(group_by_server(ids), [&](int block_id) {
+        const std::string& data = encoded_map.at(block_id);
+        return MemcachedValue{data.data(), data.size()};
+    }, "", client);
+    int success = wait_writes(w);
+
     std::cout << "[Placement] Successfully wrote " << success 
               << " / " << encoded_map.size() << " blocks.\n";
 
     return success;
 }
 
+// ---------------------------------------------------------
+// 写入全部 block（BlockView 版本）
+// ---------------------------------------------------------
+int Placement::write_all_blocks(
+    const std::vector<BlockView>& blocks,
+    MemcachedClient& client)
+{
+    PendingWrite w = write_views_async(blocks, "", client);
+    int success = wait_writes(w);
+
+    std::cout << "[Placement] Successfully wrote " << success 
+              << " / " << blocks.size() << " blocks.\n";
+
+    return success;
+}
+
+// ---------------------------------------------------------
+// 条带轮转：rack / server 整体平移（同 rack 内所有 server 平移量相同）
+// ---------------------------------------------------------
+Placement Placement::rotated(uint64_t stripe_seq, const std::string& key_prefix) const
+{
+    Placement view(*this);
+    view.key_prefix_ = key_prefix;
+
+    int rack_shift = rack_count_ > 0 ? (int)(stripe_seq % (uint64_t)rack_count_) : 0;
+    int server_shift = (rack_count_ > 0 && servers_per_rack_ > 0)
+        ? (int)((stripe_seq / (uint64_t)rack_count_) % (uint64_t)servers_per_rack_) : 0;
+    if (rack_shift == 0 && server_shift == 0) return view;
+
+    for (auto& kv : view.placement_map_) {
+        PlacementEntry& e = kv.second;
+        e.rack = (e.rack + rack_shift) % rack_count_;
+        e.server_index = (e.server_index + server_shift) % servers_per_rack_;
+    }
+    return view;
+}
+
 // ---------------------------------------------------------
 // 查 mapping
 // ---------------------------------------------------------
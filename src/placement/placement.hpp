@@ -5,8 +5,13 @@
 #include <vector>
 #include <iostream>
 #include <cassert>
+#include <functional>
+#include <memory>
+#include <cstdint>
 
 #include "memcached_client.hpp"
+#include "block_view.hpp"
+#include "io_executor.hpp"
 
 struct PlacementEntry {
     int block_id;
@@ -16,6 +21,20 @@ struct PlacementEntry {
     int server_index;
 };
 
+// 同一 server 上的一批 block（用于 mget / mset 按 server 合并请求）
+struct ServerBatch {
+    std::string ip;
+    int port;
+    std::vector<int> block_ids;
+};
+
+// 已提交、尚未等待完成的一组写入（见 Placement::write_views_async）
+struct PendingWrite {
+    typedef std::pair<size_t, std::vector<int>> BatchResult; // (batch 下标, 写失败的 block)
+    std::vector<ServerBatch> batches;
+    std::shared_ptr<CompletionQueue<BatchResult>> done;
+};
+
 class Placement {
 public:
     Placement(int k1, int m1, int k2, int m2,
@@ -36,15 +55,71 @@ public:
                      const std::string& data,
                      MemcachedClient& client);
 
+    // 写入单个 block（零拷贝视图）
+    bool write_block(const PlacementEntry& e,
+                     const BlockView& data,
+                     MemcachedClient& client);
+
     // 写入全部 block
     int write_all_blocks(
         const std::unordered_map<int, std::string>& encoded_map,
         MemcachedClient& client
     );
 
+    // 写入全部 block：blocks[block_id] 直接来自 Encoder 的零拷贝接口
+    int write_all_blocks(
+        const std::vector<BlockView>& blocks,
+        MemcachedClient& client
+    );
+
+    // 写入时每个 server 最多同时在途（已发出未确认）的请求数
+    static constexpr int kDefaultMaxInflight = 16;
+    void set_max_inflight_per_server(int n) { max_inflight_ = n > 0 ? n : 1; }
+    int max_inflight_per_server() const { return max_inflight_; }
+
+    // 写入使用的 I/O executor，默认进程共享的 IoExecutor::shared()
+    void set_io_executor(IoExecutor* io);
+
+    // 异步写入 blocks[block_id]，key 为 block_key(id) + key_suffix（分块格式用后缀区分 chunk）
+    // data 为空的视图跳过。立即返回；blocks 指向的字节需保持有效直到 wait_writes 返回
+    PendingWrite write_views_async(const std::vector<BlockView>& blocks,
+                                   const std::string& key_suffix,
+                                   MemcachedClient& client) const;
+    // 等待写入完成，返回成功写入的 block 数；failed 非空时追加写失败的 block_id
+    int wait_writes(PendingWrite& w, std::vector<int>* failed = nullptr) const;
+
     // 查 mapping
     const PlacementEntry& get(int block_id) const;
 
+    int strategy() const { return strategy_; }
+    int k1() const { return k1_; }
+    int m1() const { return m1_; }
+    int k2() const { return k2_; }
+    int m2() const { return m2_; }
+    int rack_count() const { return rack_count_; }
+    int servers_per_rack() const { return servers_per_rack_; }
+
+    // block 的 memcached key = key 前缀 + block_id。默认前缀 "block_"；
+    // 对象条带使用 "<object>:<stripe>:"，多个条带的同号 block 互不覆盖
+    static const char* const kDefaultKeyPrefix;
+    void set_key_prefix(const std::string& prefix) { key_prefix_ = prefix; }
+    const std::string& key_prefix() const { return key_prefix_; }
+    std::string block_key(int block_id) const { return key_prefix_ + std::to_string(block_id); }
+
+    // 第 stripe_seq 个条带的放置：在已生成的 mapping 上整体平移，
+    // rack 偏移 stripe_seq % rack_count，server 偏移 (stripe_seq / rack_count) % servers_per_rack。
+    // 平移是 rack / server 上的置换，块之间的同 rack、同 server 关系（即策略的容错性质）不变，
+    // 而连续条带的负载依次落到不同 rack、不同 server 上。key 前缀设为 key_prefix
+    Placement rotated(uint64_t stripe_seq, const std::string& key_prefix) const;
+
+    // block 所在 server 的地址
+    const std::string& server_ip(const PlacementEntry& e) const { return rack_ips_[e.rack]; }
+    int server_port(const PlacementEntry& e) const { return base_port_ + e.server_index; }
+
+    // 按所在 server 的地址分组（组内保持输入顺序，组按 (ip, port) 排序）
+    // 没有映射的 block 被跳过
+    std::vector<ServerBatch> group_by_server(const std::vector<int>& block_ids) const;
+
 private:
     // 参数
     int k1_, m1_, k2_, m2_;
@@ -53,6 +128,9 @@ private:
     int servers_per_rack_;
     int base_port_;
     bool use_single_vm_;
+    int max_inflight_ = kDefaultMaxInflight;
+    IoExecutor* io_;
+    std::string key_prefix_ = kDefaultKeyPrefix;
 
     // 单机测试：所有 rack 使用 127.0.0.1
     std::vector<std::string> rack_ips_;
@@ -61,6 +139,12 @@ private:
     std::unordered_map<int, PlacementEntry> placement_map_;
 
 private:
+    // 各 server 并发写入一组 batch（不等待）
+    PendingWrite submit_writes(std::vector<ServerBatch> batches,
+                               const std::function<MemcachedValue(int)>& value_of,
+                               const std::string& key_suffix,
+                               MemcachedClient& client) const;
+
     // 辅助：计算 block 的 row/col（按照 encoder flatten 顺序）
     void blockid_to_rowcol(int block_id, int &row, int &col) const;
 
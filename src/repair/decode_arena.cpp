@@ -0,0 +1,25 @@
+#include "decode_arena.hpp"
+
+#include <cstdlib>
+#include <new>
+
+DecodeArena::~DecodeArena() {
+    free(buf_);
+}
+
+void DecodeArena::reset(int slots, size_t block_size) {
+    slots_ = slots;
+    block_size_ = block_size;
+    stride_ = (block_size + kAlign - 1) / kAlign * kAlign;
+
+    size_t need = stride_ * (size_t)slots;
+    if (need > capacity_) {
+        free(buf_);
+        buf_ = nullptr;
+        capacity_ = 0;
+        void* p = nullptr;
+        if (posix_memalign(&p, kAlign, need) != 0) throw std::bad_alloc();
+        buf_ = static_cast<uint8_t*>(p);
+        capacity_ = need;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "block_view.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// 解码用的对齐缓冲区：slots 个槽位，每个槽位起始地址 64 字节对齐
+// 修复时幸存块由 MemcachedClient::get_into 直接从 socket 读入槽位，
+// GF 内核直接以槽位为输入，中间不再经过 std::string
+// reset() 只在容量不够时重新分配，可跨修复动作复用
+class DecodeArena {
+public:
+    static constexpr size_t kAlign = 64;
+
+    DecodeArena() = default;
+    ~DecodeArena();
+
+    DecodeArena(const DecodeArena&) = delete;
+    DecodeArena& operator=(const DecodeArena&) = delete;
+
+    // 内容不清零（每个槽位都会被完整读入）
+    void reset(int slots, size_t block_size);
+
+    int slots() const { return slots_; }
+    size_t block_size() const { return block_size_; }
+
+    uint8_t* slot(int i) { return buf_ + (size_t)i * stride_; }
+    const uint8_t* slot(int i) const { return buf_ + (size_t)i * stride_; }
+    BlockView view(int i, size_t len) const { return BlockView{slot(i), len}; }
+
+private:
+    uint8_t* buf_ = nullptr;
+    size_t capacity_ = 0;
+    size_t stride_ = 0;
+    size_t block_size_ = 0;
+    int slots_ = 0;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "lru_cache.hpp"
+
+#include <functional>
+#include <vector>
+
+// 解码矩阵（逆矩阵）缓存的键：
+// (行/列, k, m, 排序后的幸存块局部下标)
+struct DecodeKey {
+    bool is_row;
+    int k;
+    int m;
+    std::vector<int> survivors; // 局部下标 0..k+m-1，升序
+
+    bool operator==(const DecodeKey& o) const {
+        return is_row == o.is_row && k == o.k && m == o.m && survivors == o.survivors;
+    }
+};
+
+struct DecodeKeyHash {
+    size_t operator()(const DecodeKey& key) const {
+        size_t h = std::hash<int>()(key.k * 131 + key.m) ^ (key.is_row ? 0x9e3779b9u : 0);
+        for (int s : key.survivors)
+            h ^= std::hash<int>()(s) + 0x9e3779b9u + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+using DecodeCacheStats = LruCacheStats;
+
+// 线程安全的 LRU 逆矩阵缓存
+// 同一 (k, m) 下不同的擦除模式数量很少，修复风暴中会反复出现，
+// 命中时直接复用 k x k 逆矩阵，跳过 O(k^3) 的求逆。
+// get_or_compute 的 build 返回 false（奇异矩阵）时返回 nullptr，不缓存
+class DecodeMatrixCache : public LruCache<DecodeKey, std::vector<int>, DecodeKeyHash> {
+public:
+    using Matrix = std::vector<int>;
+    using MatrixPtr = ValuePtr;
+
+    explicit DecodeMatrixCache(size_t capacity = 1024) : LruCache(capacity) {}
+};
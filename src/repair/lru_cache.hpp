@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+struct LruCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;
+};
+
+// 线程安全的 LRU 缓存，值以 shared_ptr<const Value> 共享，淘汰后已取出的值仍有效。
+// capacity 为 0 表示不限容量
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    using ValuePtr = std::shared_ptr<const Value>;
+
+    explicit LruCache(size_t capacity) : capacity_(capacity) {}
+
+    // 命中则返回缓存的值；否则调用 build 计算（锁外执行，不阻塞其他线程的命中路径）
+    // 并插入。build 返回 false 时返回 nullptr，不缓存
+    ValuePtr get_or_compute(const Key& key, const std::function<bool(Value&)>& build) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = index_.find(key);
+            if (it != index_.end()) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                stats_.hits++;
+                return it->second->second;
+            }
+            stats_.misses++;
+        }
+
+        auto value = std::make_shared<Value>();
+        if (!build(*value)) return nullptr;
+        ValuePtr result = value;
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            // 其他线程已插入同一键
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->second;
+        }
+
+        lru_.emplace_front(key, result);
+        index_[key] = lru_.begin();
+
+        while (capacity_ > 0 && lru_.size() > capacity_) {
+            index_.erase(lru_.back().first);
+            lru_.pop_back();
+            stats_.evictions++;
+        }
+        return result;
+    }
+
+    LruCacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        LruCacheStats s = stats_;
+        s.size = lru_.size();
+        return s;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        lru_.clear();
+        index_.clear();
+    }
+
+private:
+    using Entry = std::pair<Key, ValuePtr>;
+
+    size_t capacity_;
+    mutable std::mutex mtx_;
+    std::list<Entry> lru_; // front = 最近使用
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+    LruCacheStats stats_;
+};
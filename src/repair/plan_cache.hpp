@@ -0,0 +1,45 @@
+#pragma once
+
+#include "lru_cache.hpp"
+
+#include <functional>
+#include <vector>
+
+// 规范坐标下的一步修复：修第 index 条规范行 / 列
+struct PlanStep {
+    bool is_row;
+    int index;
+};
+
+struct PlanKeyHash {
+    size_t operator()(const std::vector<int>& key) const {
+        size_t h = key.size();
+        for (int v : key)
+            h ^= std::hash<int>()(v) + 0x9e3779b9u + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+using PlanCacheStats = LruCacheStats;
+
+// 线程安全的 LRU 规划缓存
+// 键为规范化的坏块模式（见 Repair::canonical_pattern：坏块的规范坐标、涉及行 / 列上
+// 各块的机架相等关系、行 / 列内坏块的原始先后顺序等），值为规范坐标下的修复步骤。
+// 同构的坏块模式（机架重编号、行 / 列置换后相同）共享同一条目；
+// 无解的模式缓存为空步骤序列
+class RepairPlanCache : public LruCache<std::vector<int>, std::vector<PlanStep>, PlanKeyHash> {
+public:
+    using Steps = std::vector<PlanStep>;
+    using StepsPtr = ValuePtr;
+
+    explicit RepairPlanCache(size_t capacity = 16384) : LruCache(capacity) {}
+
+    // 命中则返回缓存的步骤；否则调用 build 规划（锁外执行，精确规划可能耗时较长）并插入
+    StepsPtr get_or_compute(const std::vector<int>& key,
+                            const std::function<void(Steps&)>& build) {
+        return LruCache::get_or_compute(key, [&build](Steps& steps) {
+            build(steps);
+            return true;
+        });
+    }
+};
@@ -1,19 +1,32 @@
 #include "repair.hpp"
 #include "placement.hpp"
 #include "memcached_client.hpp"
+#include "coding_matrix.hpp"
+#include "gf256_solver.hpp"
+#include "gf256_region.hpp"
+#include "io_executor.hpp"
+#include "decode_arena.hpp"
+#include "chunk_format.hpp"
 
 #include <iostream>
 #include <algorithm>
 #include <vector>
 #include <cmath>
 #include <cstring>
-#include <future> // 用于并发读取
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <jerasure.h>
-#include <jerasure/reed_sol.h>
 
 // 构造函数
 Repair::Repair(int k1, int m1, int k2, int m2)
-    : k1_(k1), m1_(m1), k2_(k2), m2_(m2), strategy_(1) {}
+    : k1_(k1), m1_(m1), k2_(k2), m2_(m2), strategy_(1), io_(&IoExecutor::shared()) {}
+
+void Repair::set_io_executor(IoExecutor* io) {
+    io_ = io ? io : &IoExecutor::shared();
+}
 
 // ---------------------------------------------------------
 // 辅助函数：坐标转换
@@ -47,29 +60,119 @@ std::vector<int> Repair::get_col_peers(int c) const {
 }
 
 // ---------------------------------------------------------
-// 核心逻辑 1：代价计算 (机架感知)
+// 幸存块选择（机架感知）
+//
+// 一条行/列可用的幸存块通常多于 k 个，实际只读其中 k 个。优先读目标机架上的块
+// （不跨机架），其余机架按可用块数从多到少取满：集中式修复的跨机架块数最少，
+// 机架内部分解码 / 流水线修复涉及的远端机架数也最少。同一机架内轮流选不同的
+// server，k 个并发读取不集中在同一台 server 上。
+// 规划（calculate_cost）与执行使用同一选择，规划代价即实际读取的流量
 // ---------------------------------------------------------
-int Repair::calculate_cost(const std::vector<int>& peer_ids, 
-                           int target_rack_id, 
-                           const std::unordered_set<int>& current_failures,
-                           const Placement& placement) 
+std::vector<std::pair<int, int>> Repair::rank_survivor_racks(
+    const std::vector<int>& peer_ids,
+    int target_rack_id,
+    const std::unordered_set<int>& current_failures,
+    const Placement& placement) const
 {
-    int cost = 0;
+    // (rack, 可用块数)，按首次出现的顺序。一行/列涉及的机架很少，线性查找即可
+    std::vector<std::pair<int, int>> racks;
     for (int bid : peer_ids) {
-        // 如果该块也是坏的，它无法提供数据，不计入读取代价
-        // (实际解码时如果缺块太多会失败，但这里只算 Cost)
         if (current_failures.count(bid)) continue;
+        int rack = -1;
+        try { rack = placement.get(bid).rack; } catch (...) {}
+        auto it = std::find_if(racks.begin(), racks.end(),
+                               [rack](const std::pair<int, int>& r) { return r.first == rack; });
+        if (it == racks.end()) racks.emplace_back(rack, 1);
+        else it->second++;
+    }
+    std::stable_sort(racks.begin(), racks.end(), [target_rack_id](const std::pair<int, int>& a,
+                                                                  const std::pair<int, int>& b) {
+        if ((a.first == target_rack_id) != (b.first == target_rack_id)) return a.first == target_rack_id;
+        return a.second > b.second;
+    });
+    return racks;
+}
 
+std::vector<int> Repair::select_survivors(const std::vector<int>& peer_ids,
+                                          int k,
+                                          int target_rack_id,
+                                          const std::unordered_set<int>& current_failures,
+                                          const Placement& placement) const
+{
+    struct Candidate { int bid; int rack; int server; bool taken; };
+    std::vector<Candidate> candidates;
+    for (int bid : peer_ids) {
+        if (current_failures.count(bid)) continue;
+        Candidate cand{bid, -1, -1, false};
         try {
-            auto entry = placement.get(bid);
-            if (entry.rack_id != target_rack_id) {
-                cost++; // 跨机架 +1
+            const PlacementEntry& e = placement.get(bid);
+            cand.rack = e.rack;
+            cand.server = e.server_index;
+        } catch (...) {}
+        candidates.push_back(cand);
+    }
+    if ((int)candidates.size() <= k) {
+        std::vector<int> all;
+        for (const Candidate& cand : candidates) all.push_back(cand.bid);
+        return all;
+    }
+
+    int need = k;
+    for (const auto& rack : rank_survivor_racks(peer_ids, target_rack_id, current_failures, placement)) {
+        // 本机架取 take 个块：每轮取已选块最少的 server 上的下一个块
+        int take = std::min(need, rack.second);
+        std::unordered_map<int, int> used;   // server_index -> 已选块数
+        for (int t = 0; t < take; ++t) {
+            Candidate* best = nullptr;
+            for (Candidate& cand : candidates) {
+                if (cand.taken || cand.rack != rack.first) continue;
+                if (!best || used[cand.server] < used[best->server]) best = &cand;
             }
-        } catch (...) {
-            // 块不存在 mapping 中？忽略
+            best->taken = true;
+            used[best->server]++;
         }
+        need -= take;
+        if (need == 0) break;
+    }
+
+    std::vector<int> selected;
+    for (const Candidate& cand : candidates)
+        if (cand.taken) selected.push_back(cand.bid);
+    return selected;
+}
+
+// ---------------------------------------------------------
+// 核心逻辑 1：代价计算 (机架感知)
+// 按 select_survivors 的选择计算，不实际构造选择结果
+// ---------------------------------------------------------
+int Repair::calculate_cost(const std::vector<int>& peer_ids,
+                           int k,
+                           int target_rack_id,
+                           const std::unordered_set<int>& current_failures,
+                           const Placement& placement)
+{
+    int remote_blocks = 0, remote_racks = 0, need = k;
+    for (const auto& rack : rank_survivor_racks(peer_ids, target_rack_id, current_failures, placement)) {
+        if (need == 0) break;
+        int take = std::min(need, rack.second);
+        need -= take;
+        // 没有映射的块无法定位机架，不计代价
+        if (rack.first == target_rack_id || rack.first < 0) continue;
+        remote_blocks += take;
+        remote_racks++;
     }
-    return cost;
+
+    // 机架内部分解码：每个远端机架对每个丢失块只发送一个聚合块
+    // 流水线：链按机架分组、目标机架在链尾，每个远端机架的出边恰好跨一次机架，
+    // 每次携带全部丢失块的部分和
+    // 代价 = 选中幸存块所在的远端机架数 x 本行/列丢失块数
+    if (mode_ == RepairMode::RACK_LOCAL || mode_ == RepairMode::PIPELINED) {
+        int lost = 0;
+        for (int bid : peer_ids) lost += (int)current_failures.count(bid);
+        return remote_racks * lost;
+    }
+    // 集中式：选中的幸存块中跨机架的块数
+    return remote_blocks;
 }
 
 // ---------------------------------------------------------
@@ -80,6 +183,8 @@ std::vector<RepairAction> Repair::plan_optimal_repair(
     const Placement& placement)
 {
     int n = failed_ids.size();
+    // 掩码状态数 2^n：超过上限时 1 << n 溢出或无法分配，退回贪心
+    if (n > kExactPlannerLimit) return plan_greedy_repair(failed_ids, placement);
     int target_mask = (1 << n) - 1;
     
     // min_cost[mask]: 达到 mask 状态的最小代价
@@ -139,7 +244,7 @@ std::vector<RepairAction> Repair::plan_optimal_repair(
             for(int i=0; i<n; ++i) { if((new_recovered_bits>>i)&1) { first_bad_idx=i; break; } }
             int target_rack = -1;
             if (first_bad_idx != -1) {
-                target_rack = placement.get(failed_ids[first_bad_idx]).rack_id;
+                target_rack = placement.get(failed_ids[first_bad_idx]).rack;
             }
 
             // 构造当前坏块集合 (用于 calculate_cost 排除坏块)
@@ -147,13 +252,13 @@ std::vector<RepairAction> Repair::plan_optimal_repair(
             for(int i=0; i<n; ++i) if(!((mask>>i)&1)) current_failures_set.insert(failed_ids[i]);
 
             std::vector<int> row_peers = get_row_peers(r);
-            int cost = calculate_cost(row_peers, target_rack, current_failures_set, placement);
+            int cost = calculate_cost(row_peers, k1_, target_rack, current_failures_set, placement);
 
             // 更新 Dijkstra
             int next_mask = mask | new_recovered_bits;
             if (min_cost[mask] + cost < min_cost[next_mask]) {
                 min_cost[next_mask] = min_cost[mask] + cost;
-                parent[next_mask] = {mask, {RepairAction::ROW, r, cost, new_recovered_bits}};
+                parent[next_mask] = {mask, {RepairAction::ROW, r, cost, {}}};
             }
         }
 
@@ -180,19 +285,19 @@ std::vector<RepairAction> Repair::plan_optimal_repair(
             for(int i=0; i<n; ++i) { if((new_recovered_bits>>i)&1) { first_bad_idx=i; break; } }
             int target_rack = -1;
             if (first_bad_idx != -1) {
-                target_rack = placement.get(failed_ids[first_bad_idx]).rack_id;
+                target_rack = placement.get(failed_ids[first_bad_idx]).rack;
             }
 
             std::unordered_set<int> current_failures_set;
             for(int i=0; i<n; ++i) if(!((mask>>i)&1)) current_failures_set.insert(failed_ids[i]);
 
             std::vector<int> col_peers = get_col_peers(c);
-            int cost = calculate_cost(col_peers, target_rack, current_failures_set, placement);
+            int cost = calculate_cost(col_peers, k2_, target_rack, current_failures_set, placement);
 
             int next_mask = mask | new_recovered_bits;
             if (min_cost[mask] + cost < min_cost[next_mask]) {
                 min_cost[next_mask] = min_cost[mask] + cost;
-                parent[next_mask] = {mask, {RepairAction::COL, c, cost, new_recovered_bits}};
+                parent[next_mask] = {mask, {RepairAction::COL, c, cost, {}}};
             }
         }
     }
@@ -212,71 +317,483 @@ std::vector<RepairAction> Repair::plan_optimal_repair(
 }
 
 // ---------------------------------------------------------
-// 核心逻辑 3：解码运算 (RS Decode via Jerasure)
+// 核心逻辑 2'：行/列贪心剥离规划
+//
+// 状态是剩余坏块集合，动作是"修一整行/列"，不再枚举 2^n 个掩码。可解（剩余坏块
+// <= m）的行/列按 代价 / 修复块数 排序（交叉相乘比较，相同时修得多的优先）；
+// 目标机架与精确规划一致，取该行/列中按 failed_ids 顺序的第一个坏块所在机架。
+// 每步修好一条行/列上的全部剩余坏块，步数不超过 行数 + 列数。
+//
+// 纯贪心会先走代价为 0 的行/列，而这些块本可以由之后的另一条顺带修好，因此：
+//   1. 每步对排名前 kGreedyBeam 的候选各接一次纯贪心估计剩余代价（pilot 法），
+//      选 本步代价 + 估计 最小的一个
+//   2. 最后逐个尝试删除动作并重放，总代价更低就接受
+// 行/列的代价只在其上的坏块变化时重算：修好一个块只影响它所在的行和列
 // ---------------------------------------------------------
-bool Repair::decode_rs(const std::unordered_map<int, std::string>& survivors,
-                       const std::vector<int>& needed_ids,
-                       int k, int m, // 对于行：k=k1, m=m1
-                       int block_size,
-                       bool is_row,
-                       std::unordered_map<int, std::string>& out_recovered)
+std::vector<RepairAction> Repair::plan_greedy_repair(
+    const std::vector<int>& failed_ids,
+    const Placement& placement)
 {
-    if (survivors.size() < (size_t)k) return false;
+    static const size_t kGreedyBeam = 3;
+    const int rows = k2_ + m2_, cols = k1_ + m1_;
 
-    // 1. 准备 Jerasure 矩阵
-    // Encoder 使用 reed_sol_vandermonde_coding_matrix(k, m+1, 8)
-    // 并且取了 Row 1 到 Row m (跳过 Row 0) 作为校验矩阵
-    // 生成完整的生成矩阵 G ( (k+m) x k )
-    // Top k is Identity
-    // Bottom m is Vandermonde
-    
-    int total_blocks = k + m;
-    int* matrix = reed_sol_vandermonde_coding_matrix(k, m + 1, 8); // (m+1) x k
-    
-    // 我们需要构建一个 vector 版本的生成矩阵 G_full (k+m) x k
-    // 用于挑选行
-    std::vector<int> G_full((k + m) * k);
-    
-    // 填充数据部分 (Identity)
-    for (int r = 0; r < k; ++r) {
-        for (int c = 0; c < k; ++c) {
-            G_full[r * k + c] = (r == c) ? 1 : 0;
+    // 行/列统一编号：0..rows-1 为行，rows..rows+cols-1 为列
+    std::vector<std::vector<int>> line_peers(rows + cols), line_failed(rows + cols);
+    for (int r = 0; r < rows; ++r) line_peers[r] = get_row_peers(r);
+    for (int c = 0; c < cols; ++c) line_peers[rows + c] = get_col_peers(c);
+    for (int i = 0; i < (int)failed_ids.size(); ++i) {
+        int r, c;
+        get_rc(failed_ids[i], r, c);
+        if (r < 0 || r >= rows) return {};
+        line_failed[r].push_back(i);
+        line_failed[rows + c].push_back(i);
+    }
+
+    struct Line {
+        bool dirty = true;
+        int cost = 0;
+        std::vector<int> lost;   // 该行/列剩余坏块（failed_ids 下标，升序）
+    };
+    struct State {
+        std::unordered_set<int> remaining;
+        std::vector<Line> lines;
+    };
+
+    auto line_m = [&](int l) { return l < rows ? m1_ : m2_; };
+    auto feasible = [&](const State& st, int l) {
+        const Line& line = st.lines[l];
+        return !line.lost.empty() && (int)line.lost.size() <= line_m(l);
+    };
+    auto refresh = [&](State& st) {
+        for (int l = 0; l < rows + cols; ++l) {
+            Line& line = st.lines[l];
+            if (!line.dirty) continue;
+            line.dirty = false;
+            line.lost.clear();
+            for (int i : line_failed[l])
+                if (st.remaining.count(failed_ids[i])) line.lost.push_back(i);
+            if (!feasible(st, l)) continue;
+            int target_rack = placement.get(failed_ids[line.lost[0]]).rack;
+            line.cost = calculate_cost(line_peers[l], l < rows ? k1_ : k2_, target_rack, st.remaining, placement);
+        }
+    };
+    // 排名前 n 的可解行/列
+    auto ranked = [&](State& st, size_t n) {
+        refresh(st);
+        std::vector<int> order;
+        for (int l = 0; l < rows + cols; ++l)
+            if (feasible(st, l)) order.push_back(l);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            const Line& x = st.lines[a];
+            const Line& y = st.lines[b];
+            long lhs = (long)x.cost * (long)y.lost.size();
+            long rhs = (long)y.cost * (long)x.lost.size();
+            return lhs < rhs || (lhs == rhs && x.lost.size() > y.lost.size());
+        });
+        if (order.size() > n) order.resize(n);
+        return order;
+    };
+    auto apply = [&](State& st, int l) {
+        std::vector<int> lost = st.lines[l].lost;
+        for (int i : lost) {
+            st.remaining.erase(failed_ids[i]);
+            int r, c;
+            get_rc(failed_ids[i], r, c);
+            st.lines[r].dirty = true;
+            st.lines[rows + c].dirty = true;
+        }
+    };
+    // 纯贪心走完：返回总代价，无法修完返回 -1
+    auto rollout = [&](State st) {
+        int total = 0;
+        while (!st.remaining.empty()) {
+            std::vector<int> top = ranked(st, 1);
+            if (top.empty()) return -1;
+            total += st.lines[top[0]].cost;
+            apply(st, top[0]);
+        }
+        return total;
+    };
+
+    State st;
+    st.remaining.insert(failed_ids.begin(), failed_ids.end());
+    st.lines.resize(rows + cols);
+
+    std::vector<RepairAction> plan;
+    while (!st.remaining.empty()) {
+        std::vector<int> top = ranked(st, kGreedyBeam);
+        if (top.empty()) return {};   // 剩余坏块所在的行列都超过 m，无法修复
+
+        int pick = top[0], pick_total = -1;
+        for (int l : top) {
+            State after = st;
+            apply(after, l);
+            int rest = rollout(std::move(after));
+            if (rest < 0) continue;
+            int total = st.lines[l].cost + rest;
+            if (pick_total < 0 || total < pick_total) {
+                pick = l;
+                pick_total = total;
+            }
+        }
+
+        bool is_row = pick < rows;
+        plan.push_back(RepairAction{is_row ? RepairAction::ROW : RepairAction::COL,
+                                    is_row ? pick : pick - rows, st.lines[pick].cost, {}});
+        apply(st, pick);
+    }
+
+    // 剪枝：逐个尝试删掉一步，按剩余顺序重放，仍可完成且总代价更低就接受
+    int best_total = 0;
+    std::vector<RepairAction> replayed;
+    if (!replay_plan(plan, failed_ids, placement, replayed, best_total)) return {};
+    plan = replayed;
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (size_t skip = 0; skip < plan.size(); ++skip) {
+            std::vector<RepairAction> trial;
+            for (size_t j = 0; j < plan.size(); ++j)
+                if (j != skip) trial.push_back(plan[j]);
+            int total = 0;
+            if (replay_plan(trial, failed_ids, placement, replayed, total) && total < best_total) {
+                plan = replayed;
+                best_total = total;
+                improved = true;
+                break;
+            }
         }
     }
-    // 填充校验部分
-    // Encoder: R[p] 对应 matrix 的第 p+1 行 (p=0..m-1)
-    for (int p = 0; p < m; ++p) {
-        for (int c = 0; c < k; ++c) {
-            // matrix 是 (m+1) x k，按行优先存储
-            // 我们要取第 p+1 行
-            G_full[(k + p) * k + c] = matrix[(p + 1) * k + c];
+    return plan;
+}
+
+// 按顺序重放行/列动作：每步修好该行/列中全部剩余坏块，重新计算代价与掩码，
+// 不再修到块的动作被丢弃。某步剩余坏块超过 m 或最后仍有坏块时返回 false
+bool Repair::replay_plan(const std::vector<RepairAction>& actions,
+                         const std::vector<int>& failed_ids,
+                         const Placement& placement,
+                         std::vector<RepairAction>& out_plan,
+                         int& out_cost)
+{
+    std::unordered_map<int, int> index_of;   // block_id -> failed_ids 下标
+    for (int i = 0; i < (int)failed_ids.size(); ++i) index_of[failed_ids[i]] = i;
+
+    std::unordered_set<int> remaining(failed_ids.begin(), failed_ids.end());
+    out_plan.clear();
+    out_cost = 0;
+    for (const RepairAction& action : actions) {
+        bool is_row = action.type == RepairAction::ROW;
+        std::vector<int> peers = is_row ? get_row_peers(action.index) : get_col_peers(action.index);
+        std::vector<int> lost;
+        for (int bid : peers)
+            if (remaining.count(bid)) lost.push_back(index_of[bid]);
+        if (lost.empty()) continue;
+        if ((int)lost.size() > (is_row ? m1_ : m2_)) return false;
+        std::sort(lost.begin(), lost.end());
+
+        RepairAction step{action.type, action.index, 0, {}};
+        int target_rack = placement.get(failed_ids[lost[0]]).rack;
+        step.cost = calculate_cost(peers, is_row ? k1_ : k2_, target_rack, remaining, placement);
+        for (int i : lost) remaining.erase(failed_ids[i]);
+        out_cost += step.cost;
+        out_plan.push_back(step);
+    }
+    return remaining.empty();
+}
+
+bool Repair::simulate_plan(const std::vector<RepairAction>& plan,
+                           const std::vector<int>& failed_ids,
+                           const Placement& placement,
+                           std::vector<std::vector<int>>& step_survivors,
+                           std::vector<std::vector<int>>& step_needed)
+{
+    step_survivors.clear();
+    step_needed.clear();
+    std::unordered_set<int> remaining(failed_ids.begin(), failed_ids.end());
+    for (const RepairAction& action : plan) {
+        bool is_row = action.type == RepairAction::ROW;
+        int k = is_row ? k1_ : k2_;
+        std::vector<int> peers = is_row ? get_row_peers(action.index) : get_col_peers(action.index);
+
+        std::vector<int> needed;
+        for (int bid : peers)
+            if (remaining.count(bid)) needed.push_back(bid);
+        if (needed.empty()) return false;
+        std::vector<int> survivors = select_survivors(peers, k, placement.get(needed[0]).rack,
+                                                      remaining, placement);
+        if ((int)survivors.size() < k) return false;
+
+        for (int bid : needed) remaining.erase(bid);
+        step_survivors.push_back(std::move(survivors));
+        step_needed.push_back(std::move(needed));
+    }
+    return remaining.empty();
+}
+
+// 第 j 步依赖修好了它某个选中幸存块的前序步骤。例如列修复用到了此前某次行修复
+// 修好的块，就必须等该行修复完成；修复互不相交的行/列、彼此不提供幸存块的步骤互不依赖
+bool Repair::link_plan(std::vector<RepairAction>& plan,
+                       const std::vector<int>& failed_ids,
+                       const Placement& placement)
+{
+    std::vector<std::vector<int>> step_survivors, step_needed;
+    if (!simulate_plan(plan, failed_ids, placement, step_survivors, step_needed)) return false;
+
+    std::unordered_map<int, int> producer;   // block_id -> 修好它的步骤
+    for (size_t j = 0; j < plan.size(); ++j)
+        for (int bid : step_needed[j]) producer[bid] = (int)j;
+    for (size_t j = 0; j < plan.size(); ++j) {
+        std::vector<int>& deps = plan[j].deps;
+        deps.clear();
+        for (int bid : step_survivors[j]) {
+            auto it = producer.find(bid);
+            if (it != producer.end()) deps.push_back(it->second);
         }
+        std::sort(deps.begin(), deps.end());
+        deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
     }
-    free(matrix); // 用完释放
+    return true;
+}
 
-    // 2. 挑选幸存块对应的行，构建解码矩阵
-    // 我们需要 k 个幸存块
-    std::vector<int> survivor_ids;
-    for (const auto& kv : survivors) {
-        if (survivor_ids.size() < k) survivor_ids.push_back(kv.first);
+// ---------------------------------------------------------
+// 核心逻辑 2''：分量拆分与规划缓存
+//
+// 坏块按所在行 / 列连通：共享行或列的坏块属于同一分量。不同分量涉及的行 / 列互不相交，
+// 一条行 / 列的可解性和代价只取决于其上的坏块，所以各分量独立规划、拼接后仍然最优。
+//
+// 分量的缓存键描述规划器能看到的全部信息，而不依赖具体的行 / 列号和机架号：
+//   - 分量涉及的行 / 列规范编号：按各自坏块所在的规范列 / 行（坏块多的在前）两轮细化排序；
+//   - 每条规范行 / 列上坏块的规范位置，按原始先后顺序列出（目标机架取该行 / 列第一个坏块）；
+//   - 涉及的行 / 列上全部块的机架，按首次出现的顺序重新编号（只保留机架相等关系）；
+//   - 修复方式与规划器。
+// 键相同的两个模式经行 / 列置换、机架重编号后完全一致，规划结果可以互相套用。
+// 策略的放置在行 / 列置换下对称时（例如每块独占机架，或机架只由行决定），
+// 不同位置的同形坏块模式会得到同一个键；不对称时键自然不同，只在完全重复时命中
+// ---------------------------------------------------------
+struct Repair::PlanPattern {
+    std::vector<int> key;
+    std::vector<int> rows;                  // 规范行号 -> 原始行号
+    std::vector<int> cols;                  // 规范列号 -> 原始列号
+    std::unordered_map<int, int> row_pos;   // 原始行号 -> 规范行号
+    std::unordered_map<int, int> col_pos;
+};
+
+std::vector<std::vector<int>> Repair::split_components(const std::vector<int>& failed_ids) const
+{
+    const int rows = k2_ + m2_;
+    // 并查集：行为节点 0..rows-1，列为节点 rows..rows+cols-1，每个坏块连接其行与列
+    std::vector<int> parent(rows + k1_ + m1_);
+    for (size_t i = 0; i < parent.size(); ++i) parent[i] = (int)i;
+    auto find = [&parent](int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    };
+    for (int bid : failed_ids) {
+        int r, c;
+        get_rc(bid, r, c);
+        parent[find(r)] = find(rows + c);
     }
 
-    std::vector<int> decoding_matrix(k * k);
-    std::vector<char*> data_ptrs(k);
-    std::vector<std::string> survivor_data_storage(k); // 保持数据存活
+    std::vector<std::vector<int>> components;
+    std::unordered_map<int, size_t> index_of;   // 根 -> 分量下标
+    for (int bid : failed_ids) {
+        int r, c;
+        get_rc(bid, r, c);
+        auto it = index_of.emplace(find(r), components.size());
+        if (it.second) components.emplace_back();
+        components[it.first->second].push_back(bid);
+    }
+    return components;
+}
+
+void Repair::canonical_pattern(const std::vector<int>& failed_ids,
+                               const Placement& placement,
+                               bool exact,
+                               PlanPattern& out) const
+{
+    const int rows = k2_ + m2_, cols = k1_ + m1_;
+
+    // 每行 / 列上的坏块，保持 failed_ids 中的先后顺序
+    std::map<int, std::vector<int>> row_lost, col_lost;
+    for (int bid : failed_ids) {
+        int r, c;
+        get_rc(bid, r, c);
+        row_lost[r].push_back(c);
+        col_lost[c].push_back(r);
+    }
+    out.rows.clear();
+    out.cols.clear();
+    for (const auto& kv : row_lost) out.rows.push_back(kv.first);
+    for (const auto& kv : col_lost) out.cols.push_back(kv.first);
+
+    auto number = [](const std::vector<int>& order, std::unordered_map<int, int>& pos) {
+        pos.clear();
+        for (int i = 0; i < (int)order.size(); ++i) pos[order[i]] = i;
+    };
+    // 按 (坏块数降序, 坏块的规范位置升序) 稳定排序
+    auto refine = [](std::vector<int>& order, const std::map<int, std::vector<int>>& lost,
+                     const std::unordered_map<int, int>& other_pos) {
+        std::unordered_map<int, std::vector<int>> sig;
+        for (int line : order) {
+            std::vector<int>& v = sig[line];
+            for (int x : lost.at(line)) v.push_back(other_pos.at(x));
+            std::sort(v.begin(), v.end());
+        }
+        std::stable_sort(order.begin(), order.end(), [&sig](int a, int b) {
+            const std::vector<int>& sa = sig[a];
+            const std::vector<int>& sb = sig[b];
+            if (sa.size() != sb.size()) return sa.size() > sb.size();
+            return sa < sb;
+        });
+    };
+    number(out.rows, out.row_pos);
+    number(out.cols, out.col_pos);
+    for (int round = 0; round < 2; ++round) {
+        refine(out.rows, row_lost, out.col_pos);
+        number(out.rows, out.row_pos);
+        refine(out.cols, col_lost, out.row_pos);
+        number(out.cols, out.col_pos);
+    }
+
+    std::vector<int>& key = out.key;
+    key.clear();
+    key.push_back((int)mode_);
+    key.push_back(exact ? 1 : 0);
+    key.push_back((int)out.rows.size());
+    key.push_back((int)out.cols.size());
+    for (int r : out.rows) {
+        const std::vector<int>& lost = row_lost[r];
+        key.push_back((int)lost.size());
+        for (int c : lost) key.push_back(out.col_pos[c]);
+    }
+    for (int c : out.cols) {
+        const std::vector<int>& lost = col_lost[c];
+        key.push_back((int)lost.size());
+        for (int r : lost) key.push_back(out.row_pos[r]);
+    }
+
+    // 行 / 列全部块的遍历顺序：分量内的按规范顺序在前，其余按原始顺序
+    std::vector<int> all_rows(out.rows), all_cols(out.cols);
+    for (int r = 0; r < rows; ++r) if (!row_lost.count(r)) all_rows.push_back(r);
+    for (int c = 0; c < cols; ++c) if (!col_lost.count(c)) all_cols.push_back(c);
+
+    std::unordered_map<int, int> label;   // 机架 -> 首次出现的序号
+    auto rack_label = [&](int bid) {
+        int rack;
+        try {
+            rack = placement.get(bid).rack;
+        } catch (...) {
+            return -1;
+        }
+        return label.emplace(rack, (int)label.size()).first->second;
+    };
+    for (int r : out.rows)
+        for (int c : all_cols) key.push_back(rack_label(get_block_id(r, c)));
+    for (int c : out.cols)
+        for (int r : all_rows) key.push_back(rack_label(get_block_id(r, c)));
+}
+
+std::vector<RepairAction> Repair::plan_repair(
+    const std::vector<int>& failed_ids,
+    const Placement& placement)
+{
+    auto use_exact = [this](size_t n) {
+        return planner_ != RepairPlanner::GREEDY && (int)n <= kExactPlannerLimit;
+    };
+    if (!plan_cache_enabled_) {
+        std::vector<RepairAction> plan = use_exact(failed_ids.size()) ? plan_optimal_repair(failed_ids, placement)
+                                                                      : plan_greedy_repair(failed_ids, placement);
+        if (!link_plan(plan, failed_ids, placement)) return {};
+        return plan;
+    }
+
+    std::vector<RepairAction> actions;
+    for (const std::vector<int>& component : split_components(failed_ids)) {
+        const bool exact = use_exact(component.size());
+        PlanPattern pattern;
+        canonical_pattern(component, placement, exact, pattern);
+
+        RepairPlanCache::StepsPtr steps = plan_cache_.get_or_compute(pattern.key,
+            [&](RepairPlanCache::Steps& out) {
+                std::vector<RepairAction> plan = exact ? plan_optimal_repair(component, placement)
+                                                       : plan_greedy_repair(component, placement);
+                for (const RepairAction& action : plan) {
+                    bool is_row = action.type == RepairAction::ROW;
+                    out.push_back(PlanStep{is_row, is_row ? pattern.row_pos.at(action.index)
+                                                          : pattern.col_pos.at(action.index)});
+                }
+            });
+        if (steps->empty()) return {};   // 分量无解
+
+        for (const PlanStep& step : *steps) {
+            actions.push_back(RepairAction{step.is_row ? RepairAction::ROW : RepairAction::COL,
+                                           step.is_row ? pattern.rows[step.index] : pattern.cols[step.index],
+                                           0, {}});
+        }
+    }
+
+    // 在实际坏块集合上重放，重新计算每步的代价，再建立依赖
+    std::vector<RepairAction> plan;
+    int cost = 0;
+    if (!replay_plan(actions, failed_ids, placement, plan, cost)) return {};
+    if (!link_plan(plan, failed_ids, placement)) return {};
+    return plan;
+}
+
+RepairPlanComparison Repair::compare_planners(const std::unordered_set<int>& failed_set,
+                                              const Placement& placement)
+{
+    std::vector<int> failed_vec(failed_set.begin(), failed_set.end());
+    std::sort(failed_vec.begin(), failed_vec.end());
+
+    auto total_cost = [](const std::vector<RepairAction>& plan) {
+        int cost = 0;
+        for (const auto& action : plan) cost += action.cost;
+        return cost;
+    };
+
+    RepairPlanComparison result;
+    if ((int)failed_vec.size() <= kExactPlannerLimit) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        auto plan = plan_optimal_repair(failed_vec, placement);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        result.exact_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        if (!plan.empty()) {
+            result.exact_cost = total_cost(plan);
+            result.exact_steps = plan.size();
+        }
+    }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    auto plan = plan_greedy_repair(failed_vec, placement);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    result.greedy_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    if (!plan.empty()) {
+        result.greedy_cost = total_cost(plan);
+        result.greedy_steps = plan.size();
+    }
+    return result;
+}
+
+// ---------------------------------------------------------
+// 核心逻辑 3：解码运算 (RS Decode)
+// 求逆仍用 Jerasure（带缓存），乘加走 GF(256) 区域内核
+// ---------------------------------------------------------
+bool Repair::decode_rs(const std::unordered_map<int, std::string>& survivors,
+                       const std::vector<int>& survivor_ids_in,
+                       const std::vector<int>& needed_ids,
+                       int k, int m, // 对于行：k=k1, m=m1
+                       size_t offset, size_t len,
+                       bool is_row,
+                       std::unordered_map<int, std::string>& out_recovered)
+{
+    if (survivor_ids_in.size() != (size_t)k) return false;
 
-    // 注意：survivor_ids 存的是全局 block_id
-    // 我们需要转成 0..(k+m)-1 的局部索引
-    // 假设 get_row_peers/col_peers 返回的顺序就是 0..k+m-1
-    // 我们需要知道每个 survivor_id 对应这一行/列的第几个块
-    
-    int row_start_idx = -1; // 这一行/列的起始 block_id
-    // 简单粗暴方法：block_id % (k+m) ? 不行，行列不一样
-    // 我们需要利用 is_row 判断
-    int cols = k1_ + m1_;
-    int rows = k2_ + m2_;
-    
     // 为了映射 block_id -> local_index (0..k+m-1)
+    // 行修复：列号就是索引；列修复：行号就是索引
     auto get_local_idx = [&](int bid) {
         int r, c;
         get_rc(bid, r, c);
@@ -284,76 +801,757 @@ bool Repair::decode_rs(const std::unordered_map<int, std::string>& survivors,
         else return r;        // 列修复，行号就是索引
     };
 
+    // 1. k 个幸存块按局部下标排序
+    // 排序后同一擦除模式总是得到同一个解码矩阵，便于逆矩阵缓存命中
+    std::vector<int> survivor_ids(survivor_ids_in);
+    std::sort(survivor_ids.begin(), survivor_ids.end(),
+              [&](int a, int b) { return get_local_idx(a) < get_local_idx(b); });
+
+    std::vector<int> survivor_local(k);
+    std::vector<const uint8_t*> data_ptrs(k);
     for (int i = 0; i < k; ++i) {
-        int bid = survivor_ids[i];
-        int local_idx = get_local_idx(bid);
-        
-        // 拷贝 G_full 的第 local_idx 行到 decoding_matrix 的第 i 行
-        for (int j = 0; j < k; ++j) {
-            decoding_matrix[i * k + j] = G_full[local_idx * k + j];
-        }
-        
-        // 准备数据指针
-        survivor_data_storage[i] = survivors.at(bid);
-        data_ptrs[i] = (char*)survivor_data_storage[i].data();
-    }
-
-    // 3. 求逆矩阵 (Jerasure)
-    // jerasure_invert_matrix 需要 int*
-    std::vector<int> inverted_matrix(k * k);
-    if (jerasure_invert_matrix(decoding_matrix.data(), inverted_matrix.data(), k, 8) == -1) {
+        auto it = survivors.find(survivor_ids[i]);
+        if (it == survivors.end()) return false;
+        const std::string& data = it->second;
+        if (data.size() < offset + len) return false;
+        survivor_local[i] = get_local_idx(survivor_ids[i]);
+        data_ptrs[i] = reinterpret_cast<const uint8_t*>(data.data()) + offset;
+    }
+
+    std::vector<int> needed_local;
+    for (int bid : needed_ids) needed_local.push_back(get_local_idx(bid));
+
+    // 2. 每个丢失块一个解码向量
+    std::vector<std::vector<uint8_t>> vectors;
+    if (!build_decode_vectors(is_row, k, m, survivor_local, needed_local, vectors))
+        return false;
+
+    // 3. 丢失块 = k 个幸存块的一次线性组合，不再先还原全部 k 个数据块
+    for (size_t n = 0; n < needed_ids.size(); ++n) {
+        std::string block(len, 0);
+        uint8_t* dst = reinterpret_cast<uint8_t*>(&block[0]);
+        for (int i = 0; i < k; ++i)
+            gf256_region_mul_xor(dst, data_ptrs[i], vectors[n][i], len);
+        out_recovered[needed_ids[n]] = std::move(block);
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------
+// 解码向量：把逆矩阵行与生成矩阵行合成为一行系数
+//   lost = sum_i vec[i] * survivor_i
+// 数据块 (local < k)：vec = inv 的第 local 行
+// 校验块 (local >= k)：vec = G_full[local] * inv
+// survivor_local 需升序（与逆矩阵缓存的键一致）
+// ---------------------------------------------------------
+bool Repair::build_decode_vectors(bool is_row, int k, int m,
+                                  const std::vector<int>& survivor_local,
+                                  const std::vector<int>& needed_local,
+                                  std::vector<std::vector<uint8_t>>& out_vectors)
+{
+    // 生成矩阵 G_full ( (k+m) x k )，来自全局编码矩阵注册表
+    // Top k is Identity
+    // Bottom m 与 Encoder 一致：reed_sol_vandermonde_coding_matrix(k, m+1, 8) 的 Row 1..m
+    auto coding = CodingMatrixRegistry::instance().get(k, m);
+    const std::vector<int>& G_full = coding->generator;
+
+    // 求逆矩阵：先查 LRU 缓存，未命中再用 Jerasure 求逆
+    DecodeKey key{is_row, k, m, survivor_local};
+    auto inverted = decode_cache_.get_or_compute(key, [&](std::vector<int>& inv) {
+        // 拷贝 G_full 的第 survivor_local[i] 行到 decoding_matrix 的第 i 行
+        std::vector<int> decoding_matrix(k * k);
+        for (int i = 0; i < k; ++i)
+            for (int j = 0; j < k; ++j)
+                decoding_matrix[i * k + j] = G_full[survivor_local[i] * k + j];
+
+        inv.assign(k * k, 0);
+        return jerasure_invert_matrix(decoding_matrix.data(), inv.data(), k, 8) != -1;
+    });
+    if (!inverted) {
         std::cerr << "[Repair] Singular matrix, cannot decode!" << std::endl;
         return false;
     }
+    const std::vector<int>& inv = *inverted;
 
-    // 4. 解码出原始 k 个数据块
-    // data_ptrs 现在指向幸存块，inverted_matrix * survivors = original_data_blocks
-    // 结果存哪里？
-    std::vector<std::string> recovered_data_blocks(k, std::string(block_size, 0));
-    std::vector<char*> recovered_data_ptrs(k);
-    for(int i=0; i<k; ++i) recovered_data_ptrs[i] = (char*)recovered_data_blocks[i].data();
-
-    jerasure_matrix_dotprod(k, 8, inverted_matrix.data(), 
-                            (int*)1, k, // row_k=1, col_k=k? dotprod定义有点怪，通常用 jerasure_matrix_encode 做乘法
-                            data_ptrs.data(), recovered_data_ptrs.data(), block_size);
-    // jerasure_matrix_dotprod: k x k matrix * k x 1 vector (of blocks) -> k x 1 vector
-    // src_rows = k, src_cols = k. 
-    // jerasure_matrix_dotprod(k, w, matrix_row, src_ids, dest_id, ...) 不是这个API
-    // 正确API: jerasure_matrix_encode(k, m, w, matrix, data_ptrs, coding_ptrs, size)
-    // 这里 k=k(inputs), m=k(outputs). matrix 是 k*k.
-    jerasure_matrix_encode(k, k, 8, inverted_matrix.data(), data_ptrs.data(), recovered_data_ptrs.data(), block_size);
-
-    // 现在 recovered_data_blocks 里是原始的 k 个数据块 (local index 0..k-1)
-    
-    // 5. 我们可能需要的是 Parity 块，或者 Data 块
-    // needed_ids 是我们需要恢复的。
-    for (int needed_bid : needed_ids) {
-        int local_idx = get_local_idx(needed_bid);
-        
-        if (local_idx < k) {
-            // 是数据块，直接拿
-            out_recovered[needed_bid] = recovered_data_blocks[local_idx];
+    out_vectors.assign(needed_local.size(), std::vector<uint8_t>(k, 0));
+    for (size_t n = 0; n < needed_local.size(); ++n) {
+        int local = needed_local[n];
+        std::vector<uint8_t>& vec = out_vectors[n];
+        if (local < k) {
+            for (int i = 0; i < k; ++i) vec[i] = static_cast<uint8_t>(inv[local * k + i]);
         } else {
-            // 是校验块，需要重新编码
-            // parity = G_row * data
-            // G_row 是 G_full 的第 local_idx 行
-            std::vector<int> coding_row(k);
-            for(int j=0; j<k; ++j) coding_row[j] = G_full[local_idx * k + j];
-            
-            std::string parity_block(block_size, 0);
-            char* p_ptr = (char*)parity_block.data();
-            
-            // 计算点积: coding_row (1xk) * data_blocks (kx1)
-            // Jerasure 没有直接的 dotprod for blocks，但可以用 matrix_encode (m=1)
-            jerasure_matrix_encode(k, 1, 8, coding_row.data(), recovered_data_ptrs.data(), &p_ptr, block_size);
-            
-            out_recovered[needed_bid] = parity_block;
+            for (int j = 0; j < k; ++j) {
+                uint8_t g = static_cast<uint8_t>(G_full[local * k + j]);
+                if (g == 0) continue;
+                for (int i = 0; i < k; ++i)
+                    vec[i] ^= gf256_mul(g, static_cast<uint8_t>(inv[j * k + i]));
+            }
         }
     }
-
     return true;
 }
 
+// ---------------------------------------------------------
+// 流量统计 & 单块读写
+// ---------------------------------------------------------
+void Repair::learn_block_size(size_t block_size) {
+    size_t unknown = 0;
+    block_size_.compare_exchange_strong(unknown, block_size);
+}
+
+void Repair::account_transfer(int src_rack, int dst_rack, uint64_t bytes) {
+    if (src_rack == dst_rack) intra_rack_bytes_ += bytes;
+    else cross_rack_bytes_ += bytes;
+}
+
+RepairTrafficStats Repair::traffic_stats() const {
+    RepairTrafficStats s;
+    s.cross_rack_bytes = cross_rack_bytes_.load();
+    s.intra_rack_bytes = intra_rack_bytes_.load();
+    s.blocks_read = blocks_read_.load();
+    s.bytes_read = bytes_read_.load();
+    s.blocks_written = blocks_written_.load();
+    s.bytes_written = bytes_written_.load();
+    return s;
+}
+
+void Repair::reset_traffic_stats() {
+    cross_rack_bytes_ = 0;
+    intra_rack_bytes_ = 0;
+    blocks_read_ = 0;
+    bytes_read_ = 0;
+    blocks_written_ = 0;
+    bytes_written_ = 0;
+}
+
+// 集中式修复：幸存块全部送到目标机架（第一个丢失块所在机架），解码后再分发
+void Repair::account_central(const std::unordered_map<int, std::string>& survivor_data,
+                             const std::unordered_map<int, std::string>& recovered,
+                             const Placement& placement) {
+    if (recovered.empty()) return;
+    int target_bid = recovered.begin()->first;
+    for (const auto& kv : recovered) target_bid = std::min(target_bid, kv.first);
+    int target_rack = placement.get(target_bid).rack;
+
+    for (const auto& kv : survivor_data)
+        account_transfer(placement.get(kv.first).rack, target_rack, kv.second.size());
+    for (const auto& kv : recovered)
+        account_transfer(target_rack, placement.get(kv.first).rack, kv.second.size());
+}
+
+bool Repair::fetch_block(int block_id, const Placement& placement,
+                         MemcachedClient& client, std::string& out) {
+    try {
+        const PlacementEntry& entry = placement.get(block_id);
+        if (!client.get(placement.server_ip(entry), placement.server_port(entry),
+                        placement.block_key(block_id), out))
+            return false;
+        ++blocks_read_;
+        bytes_read_ += out.size();
+        return true;
+    } catch (...) {}
+    return false;
+}
+
+// 一次已提交的批量读取：每个 server 一个 mget 任务，结果按完成顺序进入完成队列
+struct Repair::FetchState {
+    struct BatchResult {
+        size_t batch;
+        bool ok;
+        std::unordered_map<std::string, std::string> values;
+    };
+    std::vector<ServerBatch> batches;
+    std::string key_prefix;
+    std::string key_suffix;
+    CompletionQueue<BatchResult> done;
+};
+
+Repair::PendingFetch Repair::submit_fetch(const std::vector<int>& block_ids, const Placement& placement,
+                                          MemcachedClient& client, const std::string& key_suffix) {
+    PendingFetch state = std::make_shared<FetchState>();
+    state->batches = placement.group_by_server(block_ids);
+    state->key_prefix = placement.key_prefix();
+    state->key_suffix = key_suffix;
+
+    for (size_t b = 0; b < state->batches.size(); ++b) {
+        io_->submit(state->done, [&client, state, b]() {
+            const ServerBatch& batch = state->batches[b];
+            std::vector<std::string> keys;
+            for (int bid : batch.block_ids)
+                keys.push_back(state->key_prefix + std::to_string(bid) + state->key_suffix);
+
+            FetchState::BatchResult r{b, false, {}};
+            r.ok = client.mget(batch.ip, batch.port, keys, r.values);
+            return r;
+        });
+    }
+    return state;
+}
+
+bool Repair::collect_fetch(PendingFetch& pending, std::unordered_map<int, std::string>& out) {
+    bool ok = true;
+    for (size_t i = 0; i < pending->batches.size(); ++i) {
+        FetchState::BatchResult r = pending->done.pop();
+        ok = r.ok && ok;
+        for (int bid : pending->batches[r.batch].block_ids) {
+            auto it = r.values.find(pending->key_prefix + std::to_string(bid) + pending->key_suffix);
+            if (it == r.values.end()) {
+                ok = false;
+                continue;
+            }
+            if (pending->key_suffix.empty()) ++blocks_read_;
+            bytes_read_ += it->second.size();
+            out[bid] = std::move(it->second);
+        }
+    }
+    pending.reset();
+    return ok;
+}
+
+bool Repair::fetch_blocks(const std::vector<int>& block_ids, const Placement& placement,
+                          MemcachedClient& client, std::unordered_map<int, std::string>& out,
+                          const std::string& key_suffix) {
+    PendingFetch pending = submit_fetch(block_ids, placement, client, key_suffix);
+    // 没有映射的 block 不会出现在任何 batch 中
+    size_t grouped = 0;
+    for (const ServerBatch& batch : pending->batches) grouped += batch.block_ids.size();
+    bool ok = collect_fetch(pending, out);
+    return ok && grouped == block_ids.size();
+}
+
+bool Repair::fetch_range(const std::vector<int>& block_ids, size_t offset, size_t len,
+                         const ChunkHeader* layout, const Placement& placement, MemcachedClient& client,
+                         std::unordered_map<int, std::string>& out, size_t& slice_begin) {
+    if (!layout || layout->chunk_size == 0 || len == 0) {
+        slice_begin = 0;
+        return fetch_blocks(block_ids, placement, client, out);
+    }
+
+    // 覆盖区间的 chunk 同时发出，按 chunk 顺序收集拼接
+    const int first = (int)(offset / layout->chunk_size);
+    const int last = (int)((offset + len - 1) / layout->chunk_size);
+    if (last >= layout->chunk_count()) return false;
+    slice_begin = layout->chunk_offset(first);
+    std::vector<PendingFetch> pending;
+    for (int c = first; c <= last; ++c)
+        pending.push_back(submit_fetch(block_ids, placement, client, chunk_suffix(c)));
+
+    std::unordered_set<int> incomplete;
+    for (int c = first; c <= last; ++c) {
+        std::unordered_map<int, std::string> chunk;
+        collect_fetch(pending[c - first], chunk);
+        for (int bid : block_ids) {
+            auto it = chunk.find(bid);
+            // 长度不对的 chunk（截断、旧版本或别的块的数据）拼接后会错位，按缺失处理
+            if (it == chunk.end() || it->second.size() != layout->chunk_length(c)) incomplete.insert(bid);
+            if (incomplete.count(bid)) continue;
+            out[bid] += it->second;
+        }
+    }
+    // 缺任一 chunk 或 chunk 长度不对的块不放进 out，调用方按读取失败处理
+    for (int bid : incomplete) out.erase(bid);
+    return incomplete.empty();
+}
+
+bool Repair::store_blocks(const std::unordered_map<int, std::string>& blocks,
+                          const Placement& placement, MemcachedClient& client,
+                          const std::string& key_suffix) {
+    std::vector<int> ids;
+    for (const auto& kv : blocks) ids.push_back(kv.first);
+    std::vector<ServerBatch> batches = placement.group_by_server(ids);
+
+    CompletionQueue<bool> done;
+    for (size_t b = 0; b < batches.size(); ++b) {
+        io_->submit(done, [this, &client, &placement, &batches, &blocks, &key_suffix, b]() {
+            const ServerBatch& batch = batches[b];
+            std::vector<std::string> keys;
+            std::vector<MemcachedValue> values;
+            uint64_t bytes = 0;
+            for (int bid : batch.block_ids) {
+                const std::string& data = blocks.at(bid);
+                keys.push_back(placement.block_key(bid) + key_suffix);
+                values.push_back(MemcachedValue{data.data(), data.size()});
+                bytes += data.size();
+            }
+            if (!client.mset(batch.ip, batch.port, keys, values)) return false;
+            if (key_suffix.empty()) blocks_written_ += batch.block_ids.size();
+            bytes_written_ += bytes;
+            return true;
+        });
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < batches.size(); ++i) ok = done.pop() && ok;
+    return ok;
+}
+
+// ---------------------------------------------------------
+// 行/列修复的公共准备：从 peers（该行/列全部块，下标即局部下标）中
+// 选出丢失块与 k 个幸存块（select_survivors，局部下标升序），并求出每个丢失块的解码向量
+// needed 为空表示无需修复（返回 true）
+// ---------------------------------------------------------
+bool Repair::prepare_line_decode(const std::vector<int>& peers,
+                                 const std::vector<int>& failed_ids,
+                                 int k, int m, bool is_row,
+                                 const Placement& placement,
+                                 std::vector<int>& survivors,
+                                 std::vector<int>& needed,
+                                 std::vector<std::vector<uint8_t>>& vectors)
+{
+    std::unordered_set<int> failed_set(failed_ids.begin(), failed_ids.end());
+    std::vector<int> survivor_local, needed_local;
+    needed.clear();
+    for (int local = 0; local < (int)peers.size(); ++local) {
+        if (failed_set.count(peers[local])) {
+            needed.push_back(peers[local]);
+            needed_local.push_back(local);
+        }
+    }
+    survivors.clear();
+    if (needed.empty()) return true;
+
+    survivors = select_survivors(peers, k, placement.get(needed[0]).rack, failed_set, placement);
+    if ((int)survivors.size() < k) return false;
+    for (int local = 0; local < (int)peers.size(); ++local) {
+        if (std::find(survivors.begin(), survivors.end(), peers[local]) != survivors.end())
+            survivor_local.push_back(local);
+    }
+
+    return build_decode_vectors(is_row, k, m, survivor_local, needed_local, vectors);
+}
+
+// ---------------------------------------------------------
+// 执行层：集中式修复，幸存块零拷贝读入 DecodeArena
+//
+// k 个幸存块通过 get_into_async 并发读取，value 从 socket 直接写入
+// 64 字节对齐的槽位，GF 内核直接以槽位为输入（不经过 std::string 和 map）
+// 任一块读取失败或长度不等于 block_size_ 时返回 FALLBACK，由调用方退回 mget 路径；
+// 读取量只在全部读成功后计入（退回时由 mget 路径计数，不重复）
+// ---------------------------------------------------------
+Repair::DirectResult Repair::perform_central_direct(const std::vector<int>& peers,
+                                    const std::vector<int>& failed_ids,
+                                    int k, int m, bool is_row,
+                                    Placement& placement,
+                                    MemcachedClient& client)
+{
+    std::vector<int> survivors, needed;
+    std::vector<std::vector<uint8_t>> vectors;
+    if (!prepare_line_decode(peers, failed_ids, k, m, is_row, placement, survivors, needed, vectors))
+        return DirectResult::FAILED;
+    if (needed.empty()) return DirectResult::DONE;
+
+    const size_t block_size = block_size_;
+
+    // 每个线程一个 arena，跨修复动作复用
+    static thread_local DecodeArena arena;
+    arena.reset(k, block_size);
+
+    CompletionQueue<std::pair<bool, size_t>> done;
+    for (int i = 0; i < k; ++i) {
+        const PlacementEntry& entry = placement.get(survivors[i]);
+        client.get_into_async(placement.server_ip(entry), placement.server_port(entry),
+                              placement.block_key(survivors[i]),
+                              arena.slot(i), block_size,
+                              [&done](bool ok, size_t len) { done.push(std::make_pair(ok, len)); });
+    }
+    bool ok = true;
+    for (int i = 0; i < k; ++i) {
+        std::pair<bool, size_t> r = done.pop();
+        ok = ok && r.first && r.second == block_size;
+    }
+    if (!ok) return DirectResult::FALLBACK;
+    blocks_read_ += k;
+    bytes_read_ += (uint64_t)k * block_size;
+
+    int target_rack = placement.get(needed[0]).rack;
+    for (int bid : survivors)
+        account_transfer(placement.get(bid).rack, target_rack, block_size);
+
+    std::unordered_map<int, std::string> recovered;
+    for (size_t n = 0; n < needed.size(); ++n) {
+        std::string block(block_size, 0);
+        uint8_t* dst = reinterpret_cast<uint8_t*>(&block[0]);
+        for (int i = 0; i < k; ++i)
+            gf256_region_mul_xor(dst, arena.slot(i), vectors[n][i], block_size);
+        account_transfer(target_rack, placement.get(needed[n]).rack, block_size);
+        recovered[needed[n]] = std::move(block);
+    }
+
+    return store_blocks(recovered, placement, client) ? DirectResult::DONE : DirectResult::FAILED;
+}
+
+// ---------------------------------------------------------
+// 执行层：分块格式的流式修复
+//
+// 先读 k 个幸存块的头（必须一致），然后逐 chunk：取回 chunk c 的同时发出
+// chunk c + 1 的读取，解码出丢失块的 chunk c 并写回；全部 chunk 写完后
+// 最后写丢失块的头。内存占用与块大小无关，只与 k x chunk_size 有关
+// ---------------------------------------------------------
+bool Repair::perform_chunked_repair(const std::vector<int>& peers,
+                                    const std::vector<int>& failed_ids,
+                                    int k, int m, bool is_row,
+                                    Placement& placement,
+                                    MemcachedClient& client)
+{
+    std::vector<int> survivors, needed;
+    std::vector<std::vector<uint8_t>> vectors;
+    if (!prepare_line_decode(peers, failed_ids, k, m, is_row, placement, survivors, needed, vectors))
+        return false;
+    if (needed.empty()) return true;
+
+    std::unordered_map<int, std::string> heads;
+    if (!fetch_blocks(survivors, placement, client, heads)) return false;
+    ChunkHeader header;
+    for (int i = 0; i < k; ++i) {
+        ChunkHeader h;
+        if (!ChunkHeader::decode(heads[survivors[i]], h) ||
+            (i > 0 && (h.block_size != header.block_size || h.chunk_size != header.chunk_size))) {
+            std::cerr << "[Repair] Invalid chunk header on block " << survivors[i] << std::endl;
+            return false;
+        }
+        header = h;
+    }
+
+    const int chunks = header.chunk_count();
+    PendingFetch next;
+    if (chunks > 0) next = submit_fetch(survivors, placement, client, chunk_suffix(0));
+    // 中途失败：等已发出的下一个 chunk 的读取结束再返回（其任务引用着 client）
+    auto drain_next = [&]() {
+        if (!next) return;
+        std::unordered_map<int, std::string> drain;
+        collect_fetch(next, drain);
+    };
+
+    for (int c = 0; c < chunks; ++c) {
+        std::unordered_map<int, std::string> data;
+        bool ok = collect_fetch(next, data);
+        // 解码 chunk c 的同时读取 chunk c + 1
+        if (c + 1 < chunks) next = submit_fetch(survivors, placement, client, chunk_suffix(c + 1));
+
+        const size_t len = header.chunk_length(c);
+        for (int i = 0; ok && i < k; ++i) ok = data[survivors[i]].size() == len;
+        if (!ok) {
+            std::cerr << "[Repair] Chunk " << c << " fetch failed" << std::endl;
+            drain_next();
+            return false;
+        }
+
+        std::unordered_map<int, std::string> recovered;
+        for (size_t n = 0; n < needed.size(); ++n) {
+            std::string chunk(len, 0);
+            uint8_t* dst = reinterpret_cast<uint8_t*>(&chunk[0]);
+            for (int i = 0; i < k; ++i)
+                gf256_region_mul_xor(dst, reinterpret_cast<const uint8_t*>(data[survivors[i]].data()),
+                                     vectors[n][i], len);
+            recovered[needed[n]] = std::move(chunk);
+        }
+        account_central(data, recovered, placement);
+
+        // 任一 chunk 写回失败就不写头：没有头的块仍视为丢失，不会被读成半新半旧的数据
+        if (!store_blocks(recovered, placement, client, chunk_suffix(c))) {
+            std::cerr << "[Repair] Chunk " << c << " write-back failed" << std::endl;
+            drain_next();
+            return false;
+        }
+    }
+
+    std::unordered_map<int, std::string> new_heads;
+    for (int bid : needed) new_heads[bid] = header.encode();
+    return store_blocks(new_heads, placement, client);
+}
+
+// ---------------------------------------------------------
+// 执行层：机架内部分解码
+//
+// 幸存块按 PlacementEntry.rack 分组；每个机架内先把本机架的块汇聚到一台
+// server（机架内流量），算出 sum_{i in rack} vec[n][i] * survivor_i，
+// 每个丢失块只向目标机架发送一个聚合块。目标机架把各机架的部分和异或即得丢失块。
+// 跨机架流量 = (远端机架数) x (丢失块数) 个块，与机架内块数无关
+// ---------------------------------------------------------
+bool Repair::perform_rack_local_repair(const std::vector<int>& peers,
+                                       const std::vector<int>& failed_ids,
+                                       int k, int m, bool is_row,
+                                       Placement& placement,
+                                       MemcachedClient& client)
+{
+    std::vector<int> survivors, needed;
+    std::vector<std::vector<uint8_t>> vectors;
+    if (!prepare_line_decode(peers, failed_ids, k, m, is_row, placement, survivors, needed, vectors))
+        return false;
+    if (needed.empty()) return true;
+
+    int target_rack = placement.get(needed[0]).rack;
+    std::unordered_map<int, std::vector<int>> by_rack; // rack -> survivor 下标
+    for (int i = 0; i < k; ++i) by_rack[placement.get(survivors[i]).rack].push_back(i);
+
+    const size_t n_needed = needed.size();
+
+    // 所有幸存块按 server 分组一次性读取（I/O 在共享 executor 上完成）
+    std::unordered_map<int, std::string> blocks;
+    if (!fetch_blocks(survivors, placement, client, blocks)) {
+        std::cerr << "[Repair] Rack-local fetch failed" << std::endl;
+        return false;
+    }
+
+    // 各机架计算自己的部分和：sums[n] 对应第 n 个丢失块
+    struct RackPartial {
+        int rack;
+        bool ok = false;
+        std::vector<std::string> sums;
+    };
+    std::vector<RackPartial> partials;
+    partials.resize(by_rack.size());
+    size_t idx = 0;
+    for (const auto& kv : by_rack) partials[idx++].rack = kv.first;
+
+    for (auto& rp : partials) {
+        const std::vector<int>& members = by_rack.at(rp.rack);
+        rp.sums.assign(n_needed, std::string());
+        rp.ok = true;
+        for (size_t j = 0; j < members.size() && rp.ok; ++j) {
+            int si = members[j];
+            const std::string& block = blocks.at(survivors[si]);
+            // 第一个块所在 server 作为机架内聚合点，其余块机架内传输
+            if (j > 0) account_transfer(rp.rack, rp.rack, block.size());
+
+            for (size_t n = 0; n < n_needed; ++n) {
+                if (rp.sums[n].empty()) rp.sums[n].assign(block.size(), 0);
+                if (rp.sums[n].size() != block.size()) { rp.ok = false; break; }
+                gf256_region_mul_xor(reinterpret_cast<uint8_t*>(&rp.sums[n][0]),
+                                     reinterpret_cast<const uint8_t*>(block.data()),
+                                     vectors[n][si], block.size());
+            }
+        }
+    }
+
+    // 目标机架合并各机架的部分和
+    std::vector<std::string> recovered(n_needed);
+    for (const auto& rp : partials) {
+        if (!rp.ok) {
+            std::cerr << "[Repair] Rack-local partial failed on rack " << rp.rack << std::endl;
+            return false;
+        }
+        for (size_t n = 0; n < n_needed; ++n) {
+            account_transfer(rp.rack, target_rack, rp.sums[n].size());
+            if (recovered[n].empty()) {
+                recovered[n] = rp.sums[n];
+            } else {
+                if (recovered[n].size() != rp.sums[n].size()) return false;
+                gf256_region_xor(reinterpret_cast<uint8_t*>(&recovered[n][0]),
+                                 reinterpret_cast<const uint8_t*>(rp.sums[n].data()),
+                                 recovered[n].size());
+            }
+        }
+    }
+
+    std::unordered_map<int, std::string> write_back;
+    for (size_t n = 0; n < n_needed; ++n) {
+        account_transfer(target_rack, placement.get(needed[n]).rack, recovered[n].size());
+        write_back[needed[n]] = std::move(recovered[n]);
+    }
+    return store_blocks(write_back, placement, client);
+}
+
+// ---------------------------------------------------------
+// 流水线修复：相邻两跳之间的有界 slice 队列
+// abort() 唤醒所有等待者，push/pop 随即返回 false
+// ---------------------------------------------------------
+class SliceChannel {
+public:
+    explicit SliceChannel(size_t capacity) : capacity_(capacity) {}
+
+    bool push(std::vector<uint8_t> slice) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this] { return aborted_ || q_.size() < capacity_; });
+        if (aborted_) return false;
+        q_.push_back(std::move(slice));
+        cv_.notify_all();
+        return true;
+    }
+
+    // 返回 false：上游已结束（close）且队列为空，或已 abort
+    bool pop(std::vector<uint8_t>& slice) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this] { return aborted_ || closed_ || !q_.empty(); });
+        if (aborted_ || q_.empty()) return false;
+        slice = std::move(q_.front());
+        q_.pop_front();
+        cv_.notify_all();
+        return true;
+    }
+
+    void close() { std::lock_guard<std::mutex> lock(mtx_); closed_ = true; cv_.notify_all(); }
+    void abort() { std::lock_guard<std::mutex> lock(mtx_); aborted_ = true; cv_.notify_all(); }
+
+private:
+    size_t capacity_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::vector<uint8_t>> q_;
+    bool closed_ = false;
+    bool aborted_ = false;
+};
+
+// ---------------------------------------------------------
+// 流水线修复：跳线程名额（进程内所有 Repair 共享，共 kMaxPipelineHopThreads 个）
+// 一次修复一次性申请 k 个名额，不足时等待；只申请一部分会让并发修复互相等待而死锁。
+// k 超过上限时取全部名额，即独占运行
+// ---------------------------------------------------------
+class HopThreadBudget {
+public:
+    static HopThreadBudget& shared() {
+        static HopThreadBudget budget(Repair::kMaxPipelineHopThreads);
+        return budget;
+    }
+
+    int acquire(int n) {
+        n = std::min(n, limit_);
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [&] { return free_ >= n; });
+        free_ -= n;
+        return n;
+    }
+
+    void release(int n) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        free_ += n;
+        cv_.notify_all();
+    }
+
+private:
+    explicit HopThreadBudget(int limit) : limit_(limit), free_(limit) {}
+
+    const int limit_;
+    int free_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+};
+
+// ---------------------------------------------------------
+// 执行层：链式（流水线）部分和修复
+//
+// 1. 取 k 个幸存块（局部下标升序，与 decode_rs 一致），求每个丢失块的解码向量
+// 2. 按机架把幸存块排成一条链：目标机架（第一个丢失块所在机架）以外的机架在前，
+//    块多的机架先走，目标机架的块排在最后；同机架的块相邻，先在机架内聚合
+// 3. 每一跳一个线程：读本块，对每个 slice 把 vec[n][i] * 本块 异或进部分和，
+//    转发给下一跳；相邻跳并行处理不同 slice，延迟接近 读一块 + k 个 slice。
+//    跳之间通过有界队列互相等待，不能放在 IoExecutor / ThreadPool 上；线程总数由
+//    HopThreadBudget 限制，parallel_actions 个并发修复也不超过 kMaxPipelineHopThreads
+// 4. 最后一跳的输出即丢失块，直接写回各自的位置
+// 部分和每个 slice 携带 needed.size() 段，跨机架的只有链上机架切换处
+// ---------------------------------------------------------
+bool Repair::perform_pipelined_repair(const std::vector<int>& peers,
+                                      const std::vector<int>& failed_ids,
+                                      int k, int m, bool is_row,
+                                      Placement& placement,
+                                      MemcachedClient& client)
+{
+    std::vector<int> survivors, needed;
+    std::vector<std::vector<uint8_t>> vectors;
+    if (!prepare_line_decode(peers, failed_ids, k, m, is_row, placement, survivors, needed, vectors))
+        return false;
+    if (needed.empty()) return true;
+
+    // --- 链的顺序 ---
+    int target_rack = placement.get(needed[0]).rack;
+    std::unordered_map<int, std::vector<int>> by_rack; // rack -> survivor 下标
+    for (int i = 0; i < k; ++i) by_rack[placement.get(survivors[i]).rack].push_back(i);
+
+    std::vector<int> racks;
+    for (const auto& kv : by_rack) racks.push_back(kv.first);
+    std::sort(racks.begin(), racks.end(), [&](int a, int b) {
+        if ((a == target_rack) != (b == target_rack)) return b == target_rack;
+        if (by_rack[a].size() != by_rack[b].size()) return by_rack[a].size() > by_rack[b].size();
+        return a < b;
+    });
+
+    std::vector<int> chain; // survivor 下标，按链顺序
+    for (int rack : racks)
+        for (int i : by_rack[rack]) chain.push_back(i);
+
+    // --- 每跳一个线程，channels[h] 连接第 h-1 跳与第 h 跳，channels[k] 为输出 ---
+    const size_t n_needed = needed.size();
+    std::vector<std::unique_ptr<SliceChannel>> channels;
+    for (int h = 0; h <= k; ++h) channels.emplace_back(new SliceChannel(4));
+    std::atomic<bool> failed{false};
+
+    auto abort_all = [&]() {
+        failed = true;
+        for (auto& ch : channels) ch->abort();
+    };
+
+    const int budget = HopThreadBudget::shared().acquire(k);
+    std::vector<std::thread> hops;
+    for (int h = 0; h < k; ++h) {
+        hops.emplace_back([&, h]() {
+            int si = chain[h];
+            int bid = survivors[si];
+            int my_rack = placement.get(bid).rack;
+            int next_rack = (h + 1 < k) ? placement.get(survivors[chain[h + 1]]).rack : target_rack;
+
+            std::string block;
+            if (!fetch_block(bid, placement, client, block)) {
+                std::cerr << "[Repair] Pipeline hop failed to read block " << bid << std::endl;
+                abort_all();
+                return;
+            }
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(block.data());
+
+            auto apply = [&](std::vector<uint8_t>& partial, size_t off, size_t len) {
+                for (size_t n = 0; n < n_needed; ++n)
+                    gf256_region_mul_xor(partial.data() + n * len, src + off, vectors[n][si], len);
+            };
+
+            size_t off = 0;
+            if (h == 0) {
+                for (; off < block.size(); off += slice_size_) {
+                    size_t len = std::min(slice_size_, block.size() - off);
+                    std::vector<uint8_t> partial(n_needed * len, 0);
+                    apply(partial, off, len);
+                    account_transfer(my_rack, next_rack, partial.size());
+                    if (!channels[h + 1]->push(std::move(partial))) return;
+                }
+            } else {
+                std::vector<uint8_t> partial;
+                while (channels[h]->pop(partial)) {
+                    size_t len = partial.size() / n_needed;
+                    if (off + len > block.size()) {
+                        std::cerr << "[Repair] Pipeline block size mismatch at block " << bid << std::endl;
+                        abort_all();
+                        return;
+                    }
+                    apply(partial, off, len);
+                    off += len;
+                    account_transfer(my_rack, next_rack, partial.size());
+                    if (!channels[h + 1]->push(std::move(partial))) return;
+                }
+            }
+            channels[h + 1]->close();
+        });
+    }
+
+    // 链尾：拼接 slice 得到丢失块
+    std::vector<std::string> recovered(n_needed);
+    std::vector<uint8_t> partial;
+    while (channels[k]->pop(partial)) {
+        size_t len = partial.size() / n_needed;
+        for (size_t n = 0; n < n_needed; ++n)
+            recovered[n].append(reinterpret_cast<const char*>(partial.data() + n * len), len);
+    }
+    for (auto& t : hops) t.join();
+    HopThreadBudget::shared().release(budget);
+    if (failed) return false;
+
+    // 写回：部分和已送到目标机架，其余丢失块再从目标机架发往各自位置
+    std::unordered_map<int, std::string> write_back;
+    for (size_t n = 0; n < n_needed; ++n) {
+        account_transfer(target_rack, placement.get(needed[n]).rack, recovered[n].size());
+        write_back[needed[n]] = std::move(recovered[n]);
+    }
+    return store_blocks(write_back, placement, client);
+}
+
 // ---------------------------------------------------------
 // 执行层：Perform Row/Col Repair
 // ---------------------------------------------------------
@@ -362,66 +1560,57 @@ bool Repair::perform_row_repair(int row_idx,
                                 Placement& placement, 
                                 MemcachedClient& client)
 {
-    // 1. 确定需要读哪些块（该行所有幸存块）
+    if (chunked_)
+        return perform_chunked_repair(get_row_peers(row_idx), failed_ids, k1_, m1_, true, placement, client);
+    if (mode_ == RepairMode::PIPELINED)
+        return perform_pipelined_repair(get_row_peers(row_idx), failed_ids, k1_, m1_, true, placement, client);
+    if (mode_ == RepairMode::RACK_LOCAL)
+        return perform_rack_local_repair(get_row_peers(row_idx), failed_ids, k1_, m1_, true, placement, client);
+
+    // 已知块大小时幸存块直接读入对齐的解码缓冲区；读取失败则退回下面的 mget 路径
+    if (block_size_ > 0) {
+        DirectResult r = perform_central_direct(get_row_peers(row_idx), failed_ids, k1_, m1_, true,
+                                                placement, client);
+        if (r != DirectResult::FALLBACK) return r == DirectResult::DONE;
+    }
+
+    // 1. 确定需要读哪些块：该行的丢失块，和 select_survivors 选出的 k1 个幸存块
     std::vector<int> all_blocks = get_row_peers(row_idx);
     std::unordered_set<int> failed_set(failed_ids.begin(), failed_ids.end());
-    std::vector<int> survivors;
     std::vector<int> needed;
     
-    // 过滤出该行的需要修复块和幸存块
     for (int bid : all_blocks) {
         if (failed_set.count(bid)) needed.push_back(bid);
-        else survivors.push_back(bid);
     }
     
     if (needed.empty()) return true; // 没啥要修的
 
-    // 2. 并发读取 (Parallel Fetch)
+    std::vector<int> survivors = select_survivors(all_blocks, k1_, placement.get(needed[0]).rack,
+                                                  failed_set, placement);
+
+    // 2. 批量读取：按 server 分组 mget；缺任一幸存块都无法解码
     std::unordered_map<int, std::string> survivor_data;
-    std::vector<std::future<bool>> futures;
-    std::mutex data_mutex;
-
-    // 只需要读 k1 个就够了解码了，优化一下？
-    // 为了简单，读所有活着的，或者读前 k1 个活着的
-    if (survivors.size() > (size_t)k1_) survivors.resize(k1_);
-
-    for (int bid : survivors) {
-        futures.push_back(std::async(std::launch::async, [&, bid]() {
-            std::string val;
-            try {
-                auto entry = placement.get(bid);
-                if (client.get(entry.server_ip, entry.port, "block_" + std::to_string(bid), val)) {
-                    std::lock_guard<std::mutex> lock(data_mutex);
-                    survivor_data[bid] = val;
-                    return true;
-                }
-            } catch(...) {}
-            return false;
-        }));
+    if ((int)survivors.size() < k1_ || !fetch_blocks(survivors, placement, client, survivor_data)) {
+        std::cerr << "[Repair] Survivor fetch failed for row " << row_idx << std::endl;
+        return false;
     }
 
-    for (auto& f : futures) f.wait();
-
     // 3. 解码
-    if (survivor_data.empty()) return false;
-    int block_size = survivor_data.begin()->second.size();
+    size_t block_size = survivor_data.begin()->second.size();
+    for (const auto& kv : survivor_data)
+        if (kv.second.size() != block_size) return false;
+    learn_block_size(block_size);
     
     std::unordered_map<int, std::string> recovered;
-    if (!decode_rs(survivor_data, needed, k1_, m1_, block_size, true, recovered)) {
+    if (!decode_rs(survivor_data, survivors, needed, k1_, m1_, 0, block_size, true, recovered)) {
         std::cerr << "[Repair] Row decode failed for row " << row_idx << std::endl;
         return false;
     }
 
+    account_central(survivor_data, recovered, placement);
+
     // 4. 写回 (Write Back)
-    for (const auto& kv : recovered) {
-        int bid = kv.first;
-        try {
-            auto entry = placement.get(bid);
-            client.set(entry.server_ip, entry.port, "block_" + std::to_string(bid), kv.second);
-        } catch(...) {}
-    }
-    
-    return true;
+    return store_blocks(recovered, placement, client);
 }
 
 bool Repair::perform_col_repair(int col_idx, 
@@ -430,60 +1619,471 @@ bool Repair::perform_col_repair(int col_idx,
                                 MemcachedClient& client)
 {
     // 逻辑同 Row Repair，只是参数换成 k2, m2, is_row=false
+    if (chunked_)
+        return perform_chunked_repair(get_col_peers(col_idx), failed_ids, k2_, m2_, false, placement, client);
+    if (mode_ == RepairMode::PIPELINED)
+        return perform_pipelined_repair(get_col_peers(col_idx), failed_ids, k2_, m2_, false, placement, client);
+    if (mode_ == RepairMode::RACK_LOCAL)
+        return perform_rack_local_repair(get_col_peers(col_idx), failed_ids, k2_, m2_, false, placement, client);
+    if (block_size_ > 0) {
+        DirectResult r = perform_central_direct(get_col_peers(col_idx), failed_ids, k2_, m2_, false,
+                                                placement, client);
+        if (r != DirectResult::FALLBACK) return r == DirectResult::DONE;
+    }
+
     std::vector<int> all_blocks = get_col_peers(col_idx);
     std::unordered_set<int> failed_set(failed_ids.begin(), failed_ids.end());
-    std::vector<int> survivors;
     std::vector<int> needed;
 
     for (int bid : all_blocks) {
         if (failed_set.count(bid)) needed.push_back(bid);
-        else survivors.push_back(bid);
     }
     if (needed.empty()) return true;
 
-    if (survivors.size() > (size_t)k2_) survivors.resize(k2_);
+    std::vector<int> survivors = select_survivors(all_blocks, k2_, placement.get(needed[0]).rack,
+                                                  failed_set, placement);
 
     std::unordered_map<int, std::string> survivor_data;
-    std::vector<std::future<bool>> futures;
-    std::mutex data_mutex;
-
-    for (int bid : survivors) {
-        futures.push_back(std::async(std::launch::async, [&, bid]() {
-            std::string val;
-            try {
-                auto entry = placement.get(bid);
-                if (client.get(entry.server_ip, entry.port, "block_" + std::to_string(bid), val)) {
-                    std::lock_guard<std::mutex> lock(data_mutex);
-                    survivor_data[bid] = val;
-                    return true;
-                }
-            } catch(...) {}
-            return false;
-        }));
+    if ((int)survivors.size() < k2_ || !fetch_blocks(survivors, placement, client, survivor_data)) {
+        std::cerr << "[Repair] Survivor fetch failed for col " << col_idx << std::endl;
+        return false;
     }
-    for (auto& f : futures) f.wait();
 
-    if (survivor_data.empty()) return false;
-    int block_size = survivor_data.begin()->second.size();
+    size_t block_size = survivor_data.begin()->second.size();
+    for (const auto& kv : survivor_data)
+        if (kv.second.size() != block_size) return false;
+    learn_block_size(block_size);
 
     std::unordered_map<int, std::string> recovered;
     // 注意 k=k2, m=m2, is_row=false
-    if (!decode_rs(survivor_data, needed, k2_, m2_, block_size, false, recovered)) {
+    if (!decode_rs(survivor_data, survivors, needed, k2_, m2_, 0, block_size, false, recovered)) {
         std::cerr << "[Repair] Col decode failed for col " << col_idx << std::endl;
         return false;
     }
 
-    for (const auto& kv : recovered) {
-        int bid = kv.first;
-        try {
-            auto entry = placement.get(bid);
-            client.set(entry.server_ip, entry.port, "block_" + std::to_string(bid), kv.second);
-        } catch(...) {}
+    account_central(survivor_data, recovered, placement);
+
+    return store_blocks(recovered, placement, client);
+}
+
+// ---------------------------------------------------------
+// 执行层：按依赖并发执行修复计划
+//
+// plan[j].deps 为第 j 步选中的幸存块的生产者（link_plan）。没有依赖关系的步骤
+// 同时执行，最多 parallel_actions_ 个；每步的坏块集合取计划顺序下执行到该步时
+// 仍缺失的块（simulate_plan），与顺序执行选中的幸存块完全相同。
+//
+// CENTRAL 整块模式下分两段执行：
+//   1. 启动后立即读取原本就完好的幸存块（块大小已知时 get_into_async 直接读入
+//      DecodeArena，否则 submit_fetch），同时等待依赖步骤解码完成，
+//      因此调度器在没有可直接执行的步骤时，会提前启动依赖均已启动的步骤，
+//      用它的读取覆盖前序步骤的解码；
+//   2. 依赖步骤修好的幸存块直接从内存取（produced），不再从 memcached 回读，
+//      最后一个使用者完成后释放
+// 其他模式（PIPELINED / RACK_LOCAL / 分块）等依赖完成后调用 perform_row/col_repair。
+// 执行线程用 std::thread：步骤内部的读写会等待 IoExecutor 上的任务
+// ---------------------------------------------------------
+bool Repair::execute_repair_plan(const std::vector<RepairAction>& plan,
+                                 const std::vector<int>& failed_ids,
+                                 Placement& placement,
+                                 MemcachedClient& client)
+{
+    const size_t n = plan.size();
+    std::vector<std::vector<int>> step_survivors, step_needed;
+    if (!simulate_plan(plan, failed_ids, placement, step_survivors, step_needed)) return false;
+
+    const std::unordered_set<int> failed_set(failed_ids.begin(), failed_ids.end());
+    const bool staged = mode_ == RepairMode::CENTRAL && !chunked_;
+
+    // 第 j 步执行时仍缺失的块
+    std::vector<std::vector<int>> step_failed(n);
+    std::unordered_set<int> remaining(failed_set);
+    for (size_t j = 0; j < n; ++j) {
+        step_failed[j].assign(remaining.begin(), remaining.end());
+        std::sort(step_failed[j].begin(), step_failed[j].end());
+        for (int bid : step_needed[j]) remaining.erase(bid);
     }
 
+    enum StepState { PENDING, RUNNING, DONE, FAILED };
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<StepState> state(n, PENDING);
+    std::vector<int> consumers(n, 0);   // 还未完成的、依赖第 j 步的步骤数
+    std::unordered_map<int, std::string> produced;
+    for (const RepairAction& action : plan)
+        for (int d : action.deps) consumers[d]++;
+    int running = 0;
+    bool failed = false;
+
+    // 等待第 j 步的依赖全部完成；任一依赖失败返回 false
+    auto wait_deps = [&](size_t j) {
+        std::unique_lock<std::mutex> lock(mtx);
+        bool ok = true;
+        cv.wait(lock, [&]() {
+            for (int d : plan[j].deps) {
+                if (state[d] == FAILED) { ok = false; return true; }
+                if (state[d] != DONE) return false;
+            }
+            return true;
+        });
+        return ok;
+    };
+
+    // 块大小已知：完好的幸存块用 get_into_async 直接读入 arena 槽位，依赖步骤修好的块
+    // 从 produced 拷入槽位，GF 内核以槽位为输入。读取失败或长度不符时返回 FALLBACK，
+    // 由调用方退回 mget 路径；依赖失败或 produced 缺块时返回 FAILED，不再退回。
+    // 读取量在确定使用这批数据后才计入，退回时由 mget 路径各计一次
+    auto decode_direct = [&](size_t j, size_t block_size,
+                             std::unordered_map<int, std::string>& recovered) {
+        const bool is_row = plan[j].type == RepairAction::ROW;
+        const int k = is_row ? k1_ : k2_;
+        const std::vector<int>& survivors = step_survivors[j];
+        const std::vector<int>& needed = step_needed[j];
+        const std::vector<int> peers = is_row ? get_row_peers(plan[j].index) : get_col_peers(plan[j].index);
+        std::vector<int> survivor_local, needed_local;
+        for (int local = 0; local < (int)peers.size(); ++local) {
+            if (std::find(survivors.begin(), survivors.end(), peers[local]) != survivors.end())
+                survivor_local.push_back(local);
+            if (std::find(needed.begin(), needed.end(), peers[local]) != needed.end())
+                needed_local.push_back(local);
+        }
+        std::vector<std::vector<uint8_t>> vectors;
+        if ((int)survivors.size() != k || needed.empty() ||
+            !build_decode_vectors(is_row, k, is_row ? m1_ : m2_, survivor_local, needed_local, vectors))
+            return DirectResult::FALLBACK;
+
+        DecodeArena arena;
+        arena.reset(k, block_size);
+        CompletionQueue<std::pair<bool, size_t>> done;
+        int issued = 0;
+        for (int i = 0; i < k; ++i) {
+            if (failed_set.count(survivors[i])) continue;
+            const PlacementEntry& entry = placement.get(survivors[i]);
+            client.get_into_async(placement.server_ip(entry), placement.server_port(entry),
+                                  placement.block_key(survivors[i]), arena.slot(i), block_size,
+                                  [&done](bool ok, size_t len) { done.push(std::make_pair(ok, len)); });
+            ++issued;
+        }
+        const bool deps_ok = wait_deps(j);
+        bool ok = true;
+        for (int i = 0; i < issued; ++i) {
+            std::pair<bool, size_t> r = done.pop();
+            ok = ok && r.first && r.second == block_size;
+        }
+        if (!deps_ok) return DirectResult::FAILED;
+        if (!ok) return DirectResult::FALLBACK;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (int i = 0; i < k; ++i) {
+                if (!failed_set.count(survivors[i])) continue;
+                auto it = produced.find(survivors[i]);
+                if (it == produced.end() || it->second.size() != block_size)
+                    return DirectResult::FAILED;
+                memcpy(arena.slot(i), it->second.data(), block_size);
+            }
+        }
+        blocks_read_ += issued;
+        bytes_read_ += (uint64_t)issued * block_size;
+
+        int target_rack = placement.get(needed[0]).rack;
+        for (int bid : survivors)
+            account_transfer(placement.get(bid).rack, target_rack, block_size);
+        for (size_t n = 0; n < needed.size(); ++n) {
+            std::string block(block_size, 0);
+            uint8_t* dst = reinterpret_cast<uint8_t*>(&block[0]);
+            for (int i = 0; i < k; ++i)
+                gf256_region_mul_xor(dst, arena.slot(i), vectors[n][i], block_size);
+            account_transfer(target_rack, placement.get(needed[n]).rack, block_size);
+            recovered[needed[n]] = std::move(block);
+        }
+        return DirectResult::DONE;
+    };
+
+    // mget 路径：完好的幸存块读成 std::string，依赖步骤修好的块从 produced 取
+    auto decode_fetched = [&](size_t j, std::unordered_map<int, std::string>& recovered) {
+        bool is_row = plan[j].type == RepairAction::ROW;
+        const std::vector<int>& survivors = step_survivors[j];
+        std::vector<int> fetch_ids;
+        for (int bid : survivors)
+            if (!failed_set.count(bid)) fetch_ids.push_back(bid);
+
+        PendingFetch pending = submit_fetch(fetch_ids, placement, client, "");
+        size_t grouped = 0;
+        for (const ServerBatch& batch : pending->batches) grouped += batch.block_ids.size();
+        bool deps_ok = wait_deps(j);
+        std::unordered_map<int, std::string> survivor_data;
+        bool fetched = collect_fetch(pending, survivor_data) && grouped == fetch_ids.size();
+        if (!deps_ok || !fetched) return false;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (int bid : survivors) {
+                if (!failed_set.count(bid)) continue;
+                auto it = produced.find(bid);
+                if (it == produced.end()) return false;
+                survivor_data[bid] = it->second;
+            }
+        }
+        if (survivor_data.empty()) return false;
+        size_t block_size = survivor_data.begin()->second.size();
+        for (const auto& kv : survivor_data)
+            if (kv.second.size() != block_size) return false;
+        learn_block_size(block_size);
+
+        if (!decode_rs(survivor_data, survivors, step_needed[j], is_row ? k1_ : k2_,
+                       is_row ? m1_ : m2_, 0, block_size, is_row, recovered)) {
+            std::cerr << "[Repair] " << (is_row ? "Row" : "Col") << " decode failed for "
+                      << (is_row ? "row " : "col ") << plan[j].index << std::endl;
+            return false;
+        }
+        account_central(survivor_data, recovered, placement);
+        return true;
+    };
+
+    auto run_staged = [&](size_t j) {
+        std::unordered_map<int, std::string> recovered;
+        const size_t block_size = block_size_;
+        DirectResult direct = block_size > 0 ? decode_direct(j, block_size, recovered)
+                                             : DirectResult::FALLBACK;
+        if (direct == DirectResult::FAILED) return false;
+        if (direct == DirectResult::FALLBACK) {
+            recovered.clear();
+            if (!decode_fetched(j, recovered)) return false;
+        }
+        if (!store_blocks(recovered, placement, client)) return false;
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if (consumers[j] > 0)
+            for (const auto& kv : recovered) produced[kv.first] = kv.second;
+        return true;
+    };
+
+    auto run = [&](size_t j) {
+        bool ok;
+        if (staged) {
+            ok = run_staged(j);
+        } else {
+            ok = wait_deps(j);
+            if (ok) {
+                ok = plan[j].type == RepairAction::ROW
+                         ? perform_row_repair(plan[j].index, step_failed[j], placement, client)
+                         : perform_col_repair(plan[j].index, step_failed[j], placement, client);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mtx);
+        state[j] = ok ? DONE : FAILED;
+        if (!ok) failed = true;
+        for (int d : plan[j].deps) {
+            if (--consumers[d] == 0)
+                for (int bid : step_needed[d]) produced.erase(bid);
+        }
+        --running;
+        cv.notify_all();
+    };
+
+    // 调度：优先启动依赖已全部完成的步骤；CENTRAL 模式下再提前启动依赖均已启动的步骤
+    std::vector<std::thread> threads;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        size_t launched = 0;
+        while (launched < n && !failed) {
+            int pick = -1;
+            if (running < parallel_actions_) {
+                for (size_t j = 0; j < n && pick < 0; ++j) {
+                    if (state[j] != PENDING) continue;
+                    bool ready = true;
+                    for (int d : plan[j].deps) ready = ready && state[d] == DONE;
+                    if (ready) pick = (int)j;
+                }
+                for (size_t j = 0; staged && j < n && pick < 0; ++j) {
+                    if (state[j] != PENDING) continue;
+                    bool started = true;
+                    for (int d : plan[j].deps) started = started && state[d] != PENDING;
+                    if (started) pick = (int)j;
+                }
+            }
+            if (pick < 0) {
+                cv.wait(lock);
+                continue;
+            }
+            state[pick] = RUNNING;
+            ++running;
+            ++launched;
+            threads.emplace_back(run, (size_t)pick);
+        }
+    }
+    for (std::thread& th : threads) th.join();
+
+    for (StepState s : state)
+        if (s != DONE) return false;
     return true;
 }
 
+// ---------------------------------------------------------
+// 条带批量修复：准备
+//
+// 按计划顺序模拟（simulate_plan）：每步选中的幸存块中原本就完好的块计入 reads
+// ---------------------------------------------------------
+bool Repair::prepare_stripe_repair(const std::unordered_set<int>& failed_set,
+                                   const Placement& placement,
+                                   StripeRepairJob& job)
+{
+    job = StripeRepairJob();
+    job.failed.assign(failed_set.begin(), failed_set.end());
+    std::sort(job.failed.begin(), job.failed.end());
+    if (job.failed.empty()) return true;
+
+    job.plan = plan_repair(job.failed, placement);
+    if (job.plan.empty()) return false;
+
+    if (!simulate_plan(job.plan, job.failed, placement, job.step_survivors, job.step_needed))
+        return false;
+
+    std::unordered_set<int> reads;
+    for (size_t step = 0; step < job.plan.size(); ++step) {
+        for (int bid : job.step_survivors[step])
+            if (!failed_set.count(bid) && reads.insert(bid).second) job.reads.push_back(bid);
+        job.plan_cost += job.plan[step].cost;
+        job.naive_reads += job.step_survivors[step].size();
+    }
+    return true;
+}
+
+// ---------------------------------------------------------
+// 条带批量修复：执行
+// ---------------------------------------------------------
+bool Repair::execute_stripe_repair(const StripeRepairJob& job,
+                                   Placement& placement,
+                                   MemcachedClient& client)
+{
+    if (job.failed.empty()) return true;
+    if (chunked_) {
+        double t;
+        return repair_and_set(std::unordered_set<int>(job.failed.begin(), job.failed.end()),
+                              placement, client, t);
+    }
+
+    std::unordered_map<int, std::string> blocks;
+    if (!fetch_blocks(job.reads, placement, client, blocks) || blocks.empty()) {
+        std::cerr << "[Repair] Stripe repair: survivor fetch failed" << std::endl;
+        return false;
+    }
+    const size_t block_size = blocks.begin()->second.size();
+    for (const auto& kv : blocks) {
+        if (kv.second.size() != block_size) {
+            std::cerr << "[Repair] Stripe repair: block " << kv.first << " has size "
+                      << kv.second.size() << ", expected " << block_size << std::endl;
+            return false;
+        }
+    }
+
+    // 幸存块汇聚到第一个丢失块所在机架解码
+    int target_rack = placement.get(job.failed[0]).rack;
+    for (int bid : job.reads)
+        account_transfer(placement.get(bid).rack, target_rack, block_size);
+
+    std::unordered_map<int, std::string> recovered;
+    for (size_t step = 0; step < job.plan.size(); ++step) {
+        bool is_row = job.plan[step].type == RepairAction::ROW;
+        std::unordered_map<int, std::string> survivors;
+        for (int bid : job.step_survivors[step]) {
+            auto it = blocks.find(bid);
+            if (it == blocks.end()) return false;
+            survivors[bid] = it->second;
+        }
+        std::unordered_map<int, std::string> out;
+        if (!decode_rs(survivors, job.step_survivors[step], job.step_needed[step],
+                       is_row ? k1_ : k2_, is_row ? m1_ : m2_, 0, block_size, is_row, out)) {
+            std::cerr << "[Repair] Stripe repair: decode failed at step " << step << std::endl;
+            return false;
+        }
+        for (auto& kv : out) {
+            blocks[kv.first] = kv.second;   // 后续步骤的幸存块
+            recovered[kv.first] = std::move(kv.second);
+        }
+    }
+
+    for (const auto& kv : recovered)
+        account_transfer(target_rack, placement.get(kv.first).rack, kv.second.size());
+    return store_blocks(recovered, placement, client);
+}
+
+// ---------------------------------------------------------
+// 降级读
+//
+// 只用一行或一列重建：丢失块所在的行和列各算一次 calculate_cost
+// （目标机架取丢失块所在机架，即读请求最终服务的位置），缺失数不超过 m 的
+// 一条中选代价最小的。幸存块只取回覆盖请求区间的部分（分块格式），
+// 也只对该区间做线性组合，结果不写回
+// ---------------------------------------------------------
+bool Repair::read_degraded(int block_id, size_t offset, size_t len,
+                           const std::unordered_set<int>& unavailable,
+                           const Placement& placement,
+                           MemcachedClient& client,
+                           std::string& out,
+                           const ChunkHeader* layout)
+{
+    if (len == 0) {
+        out.clear();
+        return true;
+    }
+    std::unordered_set<int> lost(unavailable);
+    lost.insert(block_id);
+
+    int r, c;
+    get_rc(block_id, r, c);
+    int target_rack = -1;
+    try { target_rack = placement.get(block_id).rack; } catch (...) {}
+
+    // 每次重试至少多排除一个块，行列块数之和是重试次数的上界
+    for (int attempt = 0; attempt <= (k1_ + m1_) + (k2_ + m2_); ++attempt) {
+        struct Line { bool is_row; int k, m; std::vector<int> peers; int cost; };
+        std::vector<Line> lines;
+        lines.push_back(Line{true, k1_, m1_, get_row_peers(r), 0});
+        lines.push_back(Line{false, k2_, m2_, get_col_peers(c), 0});
+
+        const Line* best = nullptr;
+        for (Line& line : lines) {
+            int lost_in_line = 0;
+            for (int bid : line.peers) lost_in_line += (int)lost.count(bid);
+            if (lost_in_line > line.m) continue;
+            line.cost = calculate_cost(line.peers, line.k, target_rack, lost, placement);
+            if (!best || line.cost < best->cost) best = &line;
+        }
+        if (!best) {
+            std::cerr << "[Repair] Degraded read of block " << block_id
+                      << ": neither row nor column is decodable" << std::endl;
+            return false;
+        }
+
+        // 与 calculate_cost 一致的 k 个幸存块
+        std::vector<int> survivors = select_survivors(best->peers, best->k, target_rack, lost, placement);
+
+        // 只取回覆盖请求区间的部分（分块格式下为对应的 chunk）
+        std::unordered_map<int, std::string> data;
+        size_t slice_begin = 0;
+        if (!fetch_range(survivors, offset, len, layout, placement, client, data, slice_begin)) {
+            for (int bid : survivors) if (!data.count(bid)) lost.insert(bid);
+            continue;
+        }
+
+        std::unordered_map<int, std::string> recovered;
+        if (!decode_rs(data, survivors, {block_id}, best->k, best->m, offset - slice_begin, len,
+                       best->is_row, recovered)) {
+            std::cerr << "[Repair] Degraded read of block " << block_id
+                      << ": decode failed" << std::endl;
+            return false;
+        }
+        for (const auto& kv : data)
+            account_transfer(placement.get(kv.first).rack, target_rack, kv.second.size());
+        out = std::move(recovered[block_id]);
+        return true;
+    }
+    return false;
+}
+
 // ---------------------------------------------------------
 // 主入口
 // ---------------------------------------------------------
@@ -494,27 +2094,41 @@ bool Repair::repair_and_set(const std::unordered_set<int>& failed_set,
 {
     auto t0 = std::chrono::high_resolution_clock::now();
 
+    // 升序：规划与执行都以每行/列第一个（局部下标最小的）丢失块所在机架为目标机架
     std::vector<int> failed_vec(failed_set.begin(), failed_set.end());
+    std::sort(failed_vec.begin(), failed_vec.end());
     
-    // 1. 规划路径 (Dijkstra)
-    auto plan = plan_optimal_repair(failed_vec, placement);
+    // 1. 规划路径（少量坏块 Dijkstra，大量坏块行/列贪心）
+    auto plan = plan_repair(failed_vec, placement);
     
     if (plan.empty()) {
         std::cerr << "[Repair] No valid repair plan found!" << std::endl;
         return false;
     }
 
-    // 2. 依次执行
-    for (const auto& action : plan) {
-        bool ok = false;
-        if (action.type == RepairAction::ROW) {
-            // 注意：Dijkstra 规划的是“修整行”，这可能包含多个 failed_ids
-            // perform_row_repair 会自动处理该行所有在 failed_vec 里的块
-            ok = perform_row_repair(action.index, failed_vec, placement, client);
-        } else {
-            ok = perform_col_repair(action.index, failed_vec, placement, client);
+    // 2. 执行：多步计划按依赖并发执行；set_parallel_actions(1) 时依次执行
+    if (parallel_actions_ > 1 && plan.size() > 1) {
+        if (!execute_repair_plan(plan, failed_vec, placement, client)) return false;
+    } else {
+        // remaining 为当前仍缺失的块：前面步骤修好的块在后续步骤中是幸存块
+        std::vector<int> remaining = failed_vec;
+        for (const auto& action : plan) {
+            bool ok = false;
+            if (action.type == RepairAction::ROW) {
+                // 注意：Dijkstra 规划的是“修整行”，这可能包含多个 failed_ids
+                // perform_row_repair 会自动处理该行所有在 remaining 里的块
+                ok = perform_row_repair(action.index, remaining, placement, client);
+            } else {
+                ok = perform_col_repair(action.index, remaining, placement, client);
+            }
+            if (!ok) return false;
+
+            remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](int bid) {
+                int r, c;
+                get_rc(bid, r, c);
+                return action.type == RepairAction::ROW ? r == action.index : c == action.index;
+            }), remaining.end());
         }
-        if (!ok) return false;
     }
 
     auto t1 = std::chrono::high_resolution_clock::now();
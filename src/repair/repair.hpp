@@ -6,17 +6,76 @@
 #include <string>
 #include <chrono>
 #include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "decode_cache.hpp"
+#include "plan_cache.hpp"
 
 // 前向声明
 class MemcachedClient;
 class Placement;
+class IoExecutor;
+struct ChunkHeader;
 
 // 定义修复动作
 struct RepairAction {
     enum Type { ROW, COL } type;
     int index;          // 行号 或 列号
     int cost;           // 跨机架传输代价
-    int recovered_mask; // 这一步能修好哪些块（在 failed_set 中的下标掩码）
+    std::vector<int> deps; // 依赖的前序步骤（计划中的下标，升序）：本步选中的幸存块由它们修好
+};
+
+// 修复执行方式
+//   CENTRAL:   k 个幸存块全部拉到目标机架集中解码（原有方式）
+//   PIPELINED: 幸存块按机架排成一条链，每一跳把 系数*本块 异或进部分和，
+//              按 slice 向下一跳转发；同机架的块先聚合，跨机架只传部分和
+//   RACK_LOCAL: 每个机架先在机架内算出本机架幸存块的部分和，每个丢失块
+//              只向目标机架发一个聚合块；规划代价按机架数而非块数计算
+enum class RepairMode { CENTRAL, PIPELINED, RACK_LOCAL };
+
+// 修复路径规划器
+//   EXACT:  以坏块掩码为状态的 Dijkstra，状态数 2^n，只适合少量坏块；
+//           坏块数（分量大小）超过 kExactPlannerLimit 时退回 GREEDY
+//   GREEDY: 在行/列上贪心剥离（peeling）：每步在可解（剩余坏块数 <= m）的行/列中
+//           选 代价 / 修复块数 最小的一条，直到没有坏块。修好的块只会让其它行/列
+//           更容易解，所以精确规划有解时贪心也一定有解。数百个坏块在毫秒级完成
+//   AUTO:   坏块数 <= kExactPlannerLimit 用 EXACT，否则 GREEDY
+// 规划前坏块先按行 / 列连通性拆成互不相交的分量：不同分量不共享任何行 / 列，
+// 代价互不影响，各自规划后拼接仍是最优。AUTO 按分量大小选择规划器；
+// 分量的规划结果按规范化模式缓存（plan_cache.hpp），重叠的坏块集合直接复用
+enum class RepairPlanner { AUTO, EXACT, GREEDY };
+
+// 一个条带的批量修复任务（见 Repair::prepare_stripe_repair）
+struct StripeRepairJob {
+    std::vector<int> failed;                       // 丢失块（升序）
+    std::vector<RepairAction> plan;
+    std::vector<std::vector<int>> step_survivors;  // 每步解码用的 k 个幸存块（局部下标升序）
+    std::vector<std::vector<int>> step_needed;     // 每步修好的块
+    std::vector<int> reads;                        // 需要从存储读取的块，去重且不含前面步骤修好的块
+    size_t naive_reads = 0;                        // 逐步各自读取时的读取块数（sum k）
+    int plan_cost = 0;
+};
+
+// 同一坏块集合上两种规划器的对比（cost 为各步 calculate_cost 之和，-1 表示无解或未运行）
+struct RepairPlanComparison {
+    int exact_cost = -1;
+    int greedy_cost = -1;
+    size_t exact_steps = 0;
+    size_t greedy_steps = 0;
+    double exact_ms = 0;
+    double greedy_ms = 0;
+};
+
+// 修复过程中实际搬运的字节数（按源/目的是否同机架区分），
+// 以及从存储实际读取 / 写回的量（在读写处计数，分块格式含头和全部 chunk）
+struct RepairTrafficStats {
+    uint64_t cross_rack_bytes = 0;
+    uint64_t intra_rack_bytes = 0;
+    uint64_t blocks_read = 0;      // 读取的块数（分块格式按块头计）
+    uint64_t bytes_read = 0;
+    uint64_t blocks_written = 0;   // 写回的块数（分块格式按块头计）
+    uint64_t bytes_written = 0;
 };
 
 class Repair {
@@ -26,6 +85,53 @@ public:
     // 设置策略 (1-7)
     void set_strategy(int strategy) { strategy_ = strategy; }
 
+    // 修复执行方式；PIPELINED 模式下部分和按 slice_size 字节切片转发
+    static constexpr size_t kDefaultSliceSize = 64 * 1024;
+    void set_repair_mode(RepairMode mode) { mode_ = mode; }
+    void set_slice_size(size_t slice_size) { slice_size_ = slice_size > 0 ? slice_size : kDefaultSliceSize; }
+    // PIPELINED 每跳一个线程；进程内同时存在的跳线程不超过此数，超出的修复等待
+    static constexpr int kMaxPipelineHopThreads = 64;
+
+    // 规划器；EXACT / AUTO 都只在坏块数不超过 kExactPlannerLimit 时用精确规划
+    static constexpr int kExactPlannerLimit = 16;
+    void set_planner(RepairPlanner planner) { planner_ = planner; }
+    RepairPlanner planner() const { return planner_; }
+
+    // 规划缓存（默认打开）。关闭时每次都重新规划，用于对比
+    void set_plan_cache(bool enabled) { plan_cache_enabled_ = enabled; }
+    PlanCacheStats plan_cache_stats() const { return plan_cache_.stats(); }
+    void clear_plan_cache() { plan_cache_.clear(); }
+
+    // 对同一坏块集合分别运行两种规划器并报告代价与耗时（不执行修复）；
+    // 坏块数超过 kExactPlannerLimit 时不运行精确规划
+    RepairPlanComparison compare_planners(const std::unordered_set<int>& failed_set,
+                                          const Placement& placement);
+
+    // 多步修复计划最多同时执行的步骤数（按 RepairAction::deps 调度）；1 为逐步顺序执行
+    static constexpr int kDefaultParallelActions = 4;
+    void set_parallel_actions(int n) { parallel_actions_ = n > 0 ? n : 1; }
+    int parallel_actions() const { return parallel_actions_; }
+
+    // 块大小（字节）。已知时集中式修复把幸存块直接读入对齐的解码缓冲区
+    // （MemcachedClient::get_into）；0 表示未知，走 mget + std::string 路径，
+    // 并以首次 mget 取回的块长作为块大小，之后的修复走零拷贝路径
+    void set_block_size(size_t block_size) { block_size_ = block_size; }
+    size_t block_size() const { return block_size_; }
+
+    // 块以分块格式存储（chunk_format.hpp：头 + 每 chunk 一个 key）时打开；
+    // 此时所有修复方式都按 chunk 流式集中解码
+    void set_chunked(bool chunked) { chunked_ = chunked; }
+
+    // 幸存块读取 / 写回使用的 I/O executor，默认进程共享的 IoExecutor::shared()
+    void set_io_executor(IoExecutor* io);
+
+    // 累计流量统计
+    RepairTrafficStats traffic_stats() const;
+    void reset_traffic_stats();
+
+    // 逆矩阵缓存命中/未命中统计
+    DecodeCacheStats decode_cache_stats() const { return decode_cache_.stats(); }
+
     // 主修复入口：自动规划最优路径并执行
     // 返回 true 表示成功，repair_time 输出毫秒耗时
     bool repair_and_set(const std::unordered_set<int>& failed_set,
@@ -33,20 +139,127 @@ public:
                         MemcachedClient& client,
                         double& repair_time);
 
+    // 条带批量修复，分为准备与执行两步，便于上层在多个条带之间调度：
+    // prepare_stripe_repair 规划并模拟执行，得出每步使用的幸存块和整体需要读取的块
+    // （同一块只读一次；前面步骤修好的块留在内存中作为后续步骤的幸存块，不回读）；
+    // execute_stripe_repair 一次取回全部 reads（各 server 一次 mget），按计划在内存中
+    // 逐步解码，最后一次写回全部修复块。总是集中解码；分块格式退回 repair_and_set
+    bool prepare_stripe_repair(const std::unordered_set<int>& failed_set,
+                               const Placement& placement,
+                               StripeRepairJob& job);
+    bool execute_stripe_repair(const StripeRepairJob& job,
+                               Placement& placement,
+                               MemcachedClient& client);
+
+    // 降级读：在线重建丢失块 block_id 的 [offset, offset + len)，结果放入 out，不写回。
+    // unavailable 为调用方已知读不到的块（block_id 本身总视为丢失）。
+    // 在 block_id 所在的行和列中选 calculate_cost 最小且可解的一条；
+    // 若幸存块读取失败，把读不到的块计入 unavailable 后重新选择。
+    // layout 非空表示块按分块格式存储（chunk_format.hpp），幸存块只读
+    // 覆盖该区间的 chunk，每个 chunk 的长度须等于 layout->chunk_length(c)；
+    // nullptr 表示整块存储，幸存块整块读取
+    bool read_degraded(int block_id, size_t offset, size_t len,
+                       const std::unordered_set<int>& unavailable,
+                       const Placement& placement,
+                       MemcachedClient& client,
+                       std::string& out,
+                       const ChunkHeader* layout = nullptr);
+
 private:
     int k1_, m1_, k2_, m2_;
     int strategy_;
+    RepairMode mode_ = RepairMode::CENTRAL;
+    RepairPlanner planner_ = RepairPlanner::AUTO;
+    int parallel_actions_ = kDefaultParallelActions;
+    size_t slice_size_ = kDefaultSliceSize;
+    IoExecutor* io_;
+    std::atomic<size_t> block_size_{0};   // 并发步骤可能同时学到块大小
+    bool chunked_ = false;
+
+    std::atomic<uint64_t> cross_rack_bytes_{0};
+    std::atomic<uint64_t> intra_rack_bytes_{0};
+    std::atomic<uint64_t> blocks_read_{0};
+    std::atomic<uint64_t> bytes_read_{0};
+    std::atomic<uint64_t> blocks_written_{0};
+    std::atomic<uint64_t> bytes_written_{0};
+    void account_transfer(int src_rack, int dst_rack, uint64_t bytes);
+    // block_size_ 未知时记下 mget 取回的块长（只记第一次）
+    void learn_block_size(size_t block_size);
+    void account_central(const std::unordered_map<int, std::string>& survivor_data,
+                         const std::unordered_map<int, std::string>& recovered,
+                         const Placement& placement);
+
+    // 按 (行/列, k, m, 幸存块模式) 缓存的逆矩阵，线程安全
+    DecodeMatrixCache decode_cache_;
+
+    // 分量规划缓存
+    RepairPlanCache plan_cache_;
+    bool plan_cache_enabled_ = true;
 
     // --- 路径规划 ---
+    // 按 planner_ 选择规划器
+    std::vector<RepairAction> plan_repair(
+        const std::vector<int>& failed_ids,
+        const Placement& placement);
+
+    // 坏块按行 / 列连通性拆分成的分量（各分量内升序）
+    std::vector<std::vector<int>> split_components(const std::vector<int>& failed_ids) const;
+
+    // 一个分量的规范化模式：缓存键与规范坐标 <-> 原始行 / 列号的对应关系
+    struct PlanPattern;
+    void canonical_pattern(const std::vector<int>& failed_ids,
+                           const Placement& placement,
+                           bool exact,
+                           PlanPattern& out) const;
+
     std::vector<RepairAction> plan_optimal_repair(
         const std::vector<int>& failed_ids,
         const Placement& placement);
 
-    int calculate_cost(const std::vector<int>& peer_ids, 
-                       int target_rack_id, 
+    std::vector<RepairAction> plan_greedy_repair(
+        const std::vector<int>& failed_ids,
+        const Placement& placement);
+
+    // 按计划顺序模拟执行：每步修好的块（step_needed）与选中的 k 个幸存块（step_survivors），
+    // 与执行层的选择一致。某步无块可修、幸存块不足或最后仍有坏块时返回 false
+    bool simulate_plan(const std::vector<RepairAction>& plan,
+                       const std::vector<int>& failed_ids,
+                       const Placement& placement,
+                       std::vector<std::vector<int>>& step_survivors,
+                       std::vector<std::vector<int>>& step_needed);
+    // 填写 plan 中每步的 deps
+    bool link_plan(std::vector<RepairAction>& plan,
+                   const std::vector<int>& failed_ids,
+                   const Placement& placement);
+
+    bool replay_plan(const std::vector<RepairAction>& actions,
+                     const std::vector<int>& failed_ids,
+                     const Placement& placement,
+                     std::vector<RepairAction>& out_plan,
+                     int& out_cost);
+
+    // 用 peer_ids 修复时实际读取的幸存块（select_survivors 的结果）产生的代价
+    int calculate_cost(const std::vector<int>& peer_ids,
+                       int k,
+                       int target_rack_id,
                        const std::unordered_set<int>& current_failures,
                        const Placement& placement);
 
+    // --- 幸存块选择 ---
+    // 可用幸存块所在机架的选取顺序 (rack, 可用块数)：目标机架优先，其余按可用块数降序，
+    // 相同时按在 peer_ids 中首次出现的顺序。没有映射的块记为机架 -1
+    std::vector<std::pair<int, int>> rank_survivor_racks(const std::vector<int>& peer_ids,
+                                                         int target_rack_id,
+                                                         const std::unordered_set<int>& current_failures,
+                                                         const Placement& placement) const;
+    // 从 peer_ids 中选出 k 个读取的幸存块（不足 k 个时返回全部），按 peer_ids 顺序（局部下标升序）：
+    // 按 rank_survivor_racks 的机架顺序取满，同一机架内优先选已选块较少的 server
+    std::vector<int> select_survivors(const std::vector<int>& peer_ids,
+                                      int k,
+                                      int target_rack_id,
+                                      const std::unordered_set<int>& current_failures,
+                                      const Placement& placement) const;
+
     // --- 辅助工具 ---
     void get_rc(int block_id, int& r, int& c) const;
     int get_block_id(int r, int c) const;
@@ -54,6 +267,7 @@ private:
     std::vector<int> get_col_peers(int c) const;
 
     // --- 执行层 ---
+    // 按 deps 并发执行多步计划（见 repair.cpp）
     bool execute_repair_plan(const std::vector<RepairAction>& plan,
                              const std::vector<int>& failed_ids,
                              Placement& placement,
@@ -69,14 +283,96 @@ private:
                             Placement& placement, 
                             MemcachedClient& client);
 
-    // --- 解码运算 (Jerasure wrapper) ---
-    // 输入：survivors (id -> data), needed_ids (丢失的id)
+    // 选出丢失块 / k 个幸存块并求解码向量（PIPELINED 与 RACK_LOCAL 共用）
+    bool prepare_line_decode(const std::vector<int>& peers,
+                             const std::vector<int>& failed_ids,
+                             int k, int m, bool is_row,
+                             const Placement& placement,
+                             std::vector<int>& survivors,
+                             std::vector<int>& needed,
+                             std::vector<std::vector<uint8_t>>& vectors);
+
+    // 零拷贝读取路径的结果。FALLBACK：幸存块读取失败或长度不符，尚未写回任何数据，
+    // 调用方可退回 mget 路径重新读取；FAILED：其它失败（如写回失败），直接返回
+    enum class DirectResult { DONE, FAILED, FALLBACK };
+
+    // 集中式修复，幸存块零拷贝读入 DecodeArena（需要 block_size_ > 0）
+    DirectResult perform_central_direct(const std::vector<int>& peers,
+                                const std::vector<int>& failed_ids,
+                                int k, int m, bool is_row,
+                                Placement& placement,
+                                MemcachedClient& client);
+
+    // 分块格式：按 chunk 流式集中解码一行或一列
+    bool perform_chunked_repair(const std::vector<int>& peers,
+                                const std::vector<int>& failed_ids,
+                                int k, int m, bool is_row,
+                                Placement& placement,
+                                MemcachedClient& client);
+
+    // 机架内部分解码修复一行或一列
+    bool perform_rack_local_repair(const std::vector<int>& peers,
+                                   const std::vector<int>& failed_ids,
+                                   int k, int m, bool is_row,
+                                   Placement& placement,
+                                   MemcachedClient& client);
+
+    // 链式（流水线）修复一行或一列：peers 为该行/列全部块
+    bool perform_pipelined_repair(const std::vector<int>& peers,
+                                  const std::vector<int>& failed_ids,
+                                  int k, int m, bool is_row,
+                                  Placement& placement,
+                                  MemcachedClient& client);
+
+    // 读单个块（按 placement 定位 server）
+    bool fetch_block(int block_id, const Placement& placement,
+                     MemcachedClient& client, std::string& out);
+
+    // 批量读/写：按 server 分组，每个 server 一次 mget / mset，各 server 并发
+    // key 为 placement.block_key(id) + key_suffix；fetch_blocks 返回 true 表示全部读到
+    bool fetch_blocks(const std::vector<int>& block_ids, const Placement& placement,
+                      MemcachedClient& client, std::unordered_map<int, std::string>& out,
+                      const std::string& key_suffix = "");
+    bool store_blocks(const std::unordered_map<int, std::string>& blocks,
+                      const Placement& placement, MemcachedClient& client,
+                      const std::string& key_suffix = "");
+
+    // fetch_blocks 的拆分形式：submit_fetch 立即返回，collect_fetch 等待并合并结果，
+    // 两者之间调用方可以做计算（分块修复用它预取下一个 chunk）
+    struct FetchState;
+    typedef std::shared_ptr<FetchState> PendingFetch;
+    PendingFetch submit_fetch(const std::vector<int>& block_ids, const Placement& placement,
+                              MemcachedClient& client, const std::string& key_suffix);
+    bool collect_fetch(PendingFetch& pending, std::unordered_map<int, std::string>& out);
+
+    // 区间读取：取回各块中覆盖 [offset, offset + len) 的部分，out[id] 对应块内
+    // [slice_begin, slice_begin + out[id].size())。layout 非空时并发读取覆盖
+    // 区间的全部 chunk 并按序拼接（slice_begin 为首个 chunk 的起点），长度与
+    // layout->chunk_length(c) 不符的 chunk 按读取失败处理；否则整块读取
+    // （memcached 没有按区间 GET），slice_begin = 0
+    bool fetch_range(const std::vector<int>& block_ids, size_t offset, size_t len,
+                     const ChunkHeader* layout, const Placement& placement, MemcachedClient& client,
+                     std::unordered_map<int, std::string>& out, size_t& slice_begin);
+
+    // --- 解码运算 ---
+    // 输入：survivors (id -> data)，survivor_ids 为选定的 k 个幸存块（select_survivors
+    // 的结果，数据取自 survivors），needed_ids (丢失的id)
     // 输出：recovered (id -> data)
-    // k, m: RS 码参数 (行是 k1,m1; 列是 k2,m2)
+    // k, m: RS 码参数 (行是 k1,m1; 列是 k2,m2)；is_row 为 true 用行矩阵，false 用列矩阵
+    // 只对每个幸存块的 [offset, offset + len) 做线性组合，得到丢失块的同一区间
+    // （编码逐字节独立）。幸存块可以是整块，也可以只是包含该区间的切片
     bool decode_rs(const std::unordered_map<int, std::string>& survivors,
+                   const std::vector<int>& survivor_ids,
                    const std::vector<int>& needed_ids,
                    int k, int m,
-                   int block_size,
-                   bool is_row, // true 用行矩阵，false 用列矩阵
+                   size_t offset, size_t len,
+                   bool is_row,
                    std::unordered_map<int, std::string>& out_recovered);
+
+    // 为每个丢失块构造解码向量：lost = sum_i vec[i] * survivor_i
+    // survivor_local / needed_local 为行(列)内局部下标，survivor_local 升序且恰好 k 个
+    bool build_decode_vectors(bool is_row, int k, int m,
+                              const std::vector<int>& survivor_local,
+                              const std::vector<int>& needed_local,
+                              std::vector<std::vector<uint8_t>>& out_vectors);
 };
\ No newline at end of file
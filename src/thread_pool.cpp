@@ -0,0 +1,125 @@
+#include "thread_pool.hpp"
+#include <chrono>
+
+// 当前线程所属的 pool 及其 worker 下标（非 worker 线程为 nullptr / -1）
+static thread_local ThreadPool* tls_pool = nullptr;
+static thread_local int tls_index = -1;
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    for (int i = 0; i < threads; ++i)
+        queues_.emplace_back(new Worker());
+    for (int i = 0; i < threads; ++i)
+        workers_.emplace_back(&ThreadPool::worker_loop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mtx_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+void ThreadPool::submit(Task task) {
+    int index = (tls_pool == this) ? tls_index
+                                   : (int)(next_queue_++ % queues_.size());
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mtx);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mtx_);
+        pending_++;
+    }
+    sleep_cv_.notify_one();
+}
+
+bool ThreadPool::pop_local(int index, Task& out) {
+    Worker& w = *queues_[index];
+    std::lock_guard<std::mutex> lock(w.mtx);
+    if (w.tasks.empty()) return false;
+    out = std::move(w.tasks.back());
+    w.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int thief, Task& out) {
+    int n = (int)queues_.size();
+    int start = thief < 0 ? (int)(next_queue_.load() % n) : thief + 1;
+    for (int i = 0; i < n; ++i) {
+        int victim = (start + i) % n;
+        if (victim == thief) continue;
+        Worker& w = *queues_[victim];
+        std::lock_guard<std::mutex> lock(w.mtx);
+        if (w.tasks.empty()) continue;
+        out = std::move(w.tasks.front());
+        w.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::run_one() {
+    int index = (tls_pool == this) ? tls_index : -1;
+    Task task;
+    if (!((index >= 0 && pop_local(index, task)) || steal(index, task)))
+        return false;
+    pending_--;
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(int index) {
+    tls_pool = this;
+    tls_index = index;
+
+    for (;;) {
+        if (run_one()) continue;
+
+        std::unique_lock<std::mutex> lock(sleep_mtx_);
+        sleep_cv_.wait(lock, [this] { return stop_ || pending_.load() > 0; });
+        if (stop_ && pending_.load() == 0) return;
+    }
+}
+
+// ---------------------------------------------------------
+// TaskGroup
+// ---------------------------------------------------------
+TaskGroup::~TaskGroup() {
+    // 不允许任务引用已销毁的 group
+    try { wait(); } catch (...) {}
+}
+
+void TaskGroup::run(std::function<void()> fn) {
+    pending_++;
+    pool_.submit([this, fn = std::move(fn)]() {
+        try {
+            fn();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!error_) error_ = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (--pending_ == 0) cv_.notify_all();
+    });
+}
+
+void TaskGroup::wait() {
+    while (pending_.load() > 0) {
+        if (pool_.run_one()) continue;
+        // 没有可偷的任务：剩余任务正在其他线程执行，短暂等待
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait_for(lock, std::chrono::microseconds(200),
+                     [this] { return pending_.load() == 0; });
+    }
+    std::exception_ptr err;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        std::swap(err, error_);
+    }
+    if (err) std::rethrow_exception(err);
+}
@@ -0,0 +1,74 @@
+//thread_pool.hpp
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool.
+// Each worker owns a deque: it pushes/pops its own tasks at the back (LIFO,
+// cache friendly for nested fork/join) and steals from the front of other
+// workers' deques when idle. Tasks submitted from outside the pool are
+// spread round-robin. Threads that wait on a TaskGroup help run tasks, so
+// tasks may themselves fork and join without deadlocking the pool.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads <= 0 -> std::thread::hardware_concurrency()
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)workers_.size(); }
+
+    void submit(Task task);
+
+    // Run one pending task on the calling thread, if any. Returns false when
+    // every deque was empty.
+    bool run_one();
+
+private:
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex sleep_mtx_;
+    std::condition_variable sleep_cv_;
+    std::atomic<int> pending_{0};
+    std::atomic<unsigned> next_queue_{0};
+    bool stop_ = false;
+
+    void worker_loop(int index);
+    bool pop_local(int index, Task& out);
+    bool steal(int thief, Task& out);
+};
+
+// Fork/join helper on top of ThreadPool. wait() executes pending pool tasks
+// while the group is unfinished and rethrows the first task exception.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool) {}
+    ~TaskGroup();
+
+    void run(std::function<void()> fn);
+    void wait();
+
+private:
+    ThreadPool& pool_;
+    std::atomic<int> pending_{0};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::exception_ptr error_;
+};
@@ -0,0 +1,40 @@
+// coding_matrix_test.cpp
+// 编码矩阵注册表不依赖调用方先 init_tables()：本测试在任何 GF 初始化之前
+// 从多个线程同时请求矩阵，半字节表必须与 gf256_mul 一致（而不是全零）
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "coding_matrix.hpp"
+#include "gf256_solver.hpp"
+#include "test_common.hpp"
+
+int main() {
+    std::vector<std::shared_ptr<const CodingMatrix>> mats(4);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back([&mats, i]() { mats[i] = CodingMatrixRegistry::instance().get(4 + i % 2, 2); });
+    for (std::thread& th : threads) th.join();
+
+    for (const auto& mat : mats) {
+        CHECK(mat && (int)mat->tables.size() == mat->m * mat->k);
+        bool nonzero = false;
+        for (int p = 0; p < mat->m; ++p) {
+            for (int c = 0; c < mat->k; ++c) {
+                const uint8_t coef = mat->coef(p, c);
+                nonzero = nonzero || coef != 0;
+                for (int i = 0; i < 16; ++i) {
+                    CHECK(mat->table(p, c).lo[i] == gf256_mul(coef, (uint8_t)i));
+                    CHECK(mat->table(p, c).hi[i] == gf256_mul(coef, (uint8_t)(i << 4)));
+                }
+                CHECK(coef < 2 || mat->table(p, c).lo[1] == coef);
+            }
+        }
+        CHECK(nonzero);
+    }
+    // 同一 (k, m) 只构建一次
+    CHECK(CodingMatrixRegistry::instance().get(4, 2) == mats[0]);
+
+    std::cout << "coding_matrix_test: ok" << std::endl;
+    return 0;
+}
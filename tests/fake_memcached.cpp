@@ -0,0 +1,506 @@
+// fake_memcached.cpp
+#include "fake_memcached.hpp"
+
+#include <libmemcached/memcached.h>
+#include <libmemcached/util.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------
+// shared store
+// ---------------------------------------------------------
+namespace {
+
+struct Store {
+    std::mutex mtx;
+    fake_memcached::Snapshot data;
+    std::set<std::string> down;
+    size_t max_item_size = 0;
+    std::atomic<long> latency_us{0};
+    std::atomic<size_t> gets{0};
+    std::atomic<size_t> binary_gets{0};
+    std::atomic<size_t> sets{0};
+};
+
+Store& store() {
+    static Store s;
+    return s;
+}
+
+void delay() {
+    long us = store().latency_us.load();
+    if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+bool is_down(const std::string& server) {
+    std::lock_guard<std::mutex> lock(store().mtx);
+    return store().down.count(server) > 0;
+}
+
+// 0 = stored, otherwise the memcached_return_t the server answers with
+memcached_return_t store_value(const std::string& server, const std::string& key,
+                               const char* value, size_t len) {
+    Store& s = store();
+    s.sets++;
+    std::lock_guard<std::mutex> lock(s.mtx);
+    if (s.down.count(server)) return MEMCACHED_CONNECTION_FAILURE;
+    if (s.max_item_size > 0 && len > s.max_item_size) return MEMCACHED_E2BIG;
+    s.data[server][key].assign(value, len);
+    return MEMCACHED_SUCCESS;
+}
+
+bool load_value(const std::string& server, const std::string& key, std::string& out) {
+    Store& s = store();
+    s.gets++;
+    std::lock_guard<std::mutex> lock(s.mtx);
+    auto srv = s.data.find(server);
+    if (srv == s.data.end()) return false;
+    auto it = srv->second.find(key);
+    if (it == srv->second.end()) return false;
+    out = it->second;
+    return true;
+}
+
+} // namespace
+
+namespace fake_memcached {
+
+void clear() {
+    std::lock_guard<std::mutex> lock(store().mtx);
+    store().data.clear();
+}
+
+Snapshot snapshot() {
+    std::lock_guard<std::mutex> lock(store().mtx);
+    return store().data;
+}
+
+void restore(const Snapshot& snap) {
+    std::lock_guard<std::mutex> lock(store().mtx);
+    store().data = snap;
+}
+
+bool get(const std::string& server, const std::string& key, std::string& value) {
+    std::lock_guard<std::mutex> lock(store().mtx);
+    auto srv = store().data.find(server);
+    if (srv == store().data.end()) return false;
+    auto it = srv->second.find(key);
+    if (it == srv->second.end()) return false;
+    value = it->second;
+    return true;
+}
+
+bool erase(const std::string& server, const std::string& key) {
+    std::lock_guard<std::mutex> lock(store().mtx);
+    auto srv = store().data.find(server);
+    return srv != store().data.end() && srv->second.erase(key) > 0;
+}
+
+void set_down(const std::string& server, bool down) {
+    std::lock_guard<std::mutex> lock(store().mtx);
+    if (down) store().down.insert(server);
+    else store().down.erase(server);
+}
+
+void set_max_item_size(size_t bytes) {
+    std::lock_guard<std::mutex> lock(store().mtx);
+    store().max_item_size = bytes;
+}
+
+void set_latency(std::chrono::microseconds latency) {
+    store().latency_us = (long)latency.count();
+}
+
+size_t get_count() { return store().gets; }
+size_t binary_get_count() { return store().binary_gets; }
+size_t set_count() { return store().sets; }
+
+} // namespace fake_memcached
+
+// ---------------------------------------------------------
+// binary protocol server (for MemcachedAsyncEngine)
+// one acceptor thread polls the listeners, one thread per connection
+// ---------------------------------------------------------
+namespace {
+
+const size_t kHeaderSize = 24;
+
+struct Server {
+    std::vector<std::pair<int, int>> listeners;   // (fd, port)
+    std::thread acceptor;
+    std::atomic<bool> stopping{false};
+    std::mutex mtx;
+    std::vector<int> conns;
+    std::vector<std::thread> workers;
+};
+
+std::unique_ptr<Server> g_server;
+
+uint32_t read_u32(const unsigned char* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+void put_u16(std::string& out, uint16_t v) {
+    out.push_back((char)(v >> 8));
+    out.push_back((char)(v & 0xff));
+}
+
+void put_u32(std::string& out, uint32_t v) {
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back((char)((v >> shift) & 0xff));
+}
+
+void respond(std::string& out, uint8_t opcode, uint16_t status, uint32_t opaque,
+             const std::string& extras, const std::string& value) {
+    out.push_back((char)0x81);
+    out.push_back((char)opcode);
+    put_u16(out, 0);
+    out.push_back((char)extras.size());
+    out.push_back(0);
+    put_u16(out, status);
+    put_u32(out, (uint32_t)(extras.size() + value.size()));
+    put_u32(out, opaque);
+    put_u32(out, 0);
+    put_u32(out, 0);
+    out += extras;
+    out += value;
+}
+
+bool send_all(int fd, const std::string& out) {
+    size_t off = 0;
+    while (off < out.size()) {
+        ssize_t n = send(fd, out.data() + off, out.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        off += (size_t)n;
+    }
+    return true;
+}
+
+void serve_connection(int fd, std::string server) {
+    std::string in, out;
+    std::vector<char> buf(64 * 1024);
+    for (;;) {
+        ssize_t n = recv(fd, buf.data(), buf.size(), 0);
+        if (n <= 0) break;
+        if (is_down(server)) break;
+        in.append(buf.data(), (size_t)n);
+        delay();
+
+        size_t off = 0;
+        while (in.size() - off >= kHeaderSize) {
+            const unsigned char* h = reinterpret_cast<const unsigned char*>(in.data() + off);
+            uint16_t key_len = (uint16_t)((h[2] << 8) | h[3]);
+            uint8_t extras_len = h[4];
+            uint32_t body_len = read_u32(h + 8);
+            uint32_t opaque = read_u32(h + 12);
+            if (in.size() - off < kHeaderSize + body_len) break;
+
+            const char* body = in.data() + off + kHeaderSize;
+            std::string key(body + extras_len, key_len);
+            uint8_t opcode = h[1];
+            if (opcode == 0x01) {
+                const char* value = body + extras_len + key_len;
+                size_t value_len = body_len - extras_len - key_len;
+                memcached_return_t rc = store_value(server, key, value, value_len);
+                respond(out, opcode, rc == MEMCACHED_SUCCESS ? 0 : rc == MEMCACHED_E2BIG ? 0x03 : 0x84,
+                        opaque, "", "");
+            } else if (opcode == 0x00) {
+                std::string value;
+                store().binary_gets++;
+                if (load_value(server, key, value))
+                    respond(out, opcode, 0, opaque, std::string(4, '\0'), value);
+                else
+                    respond(out, opcode, 0x01, opaque, "", "Not found");
+            } else {
+                respond(out, opcode, 0x81, opaque, "", "Unknown command");
+            }
+            off += kHeaderSize + body_len;
+        }
+        in.erase(0, off);
+        if (!out.empty() && !send_all(fd, out)) break;
+        out.clear();
+    }
+    shutdown(fd, SHUT_RDWR);
+}
+
+void accept_loop(Server* srv) {
+    std::vector<struct pollfd> fds;
+    for (const auto& l : srv->listeners) fds.push_back({l.first, POLLIN, 0});
+    while (!srv->stopping) {
+        if (poll(fds.data(), fds.size(), 50) <= 0) continue;
+        for (size_t i = 0; i < fds.size(); ++i) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            int fd = accept(fds[i].fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            std::string server = "127.0.0.1:" + std::to_string(srv->listeners[i].second);
+            std::lock_guard<std::mutex> lock(srv->mtx);
+            srv->conns.push_back(fd);
+            srv->workers.emplace_back(serve_connection, fd, server);
+        }
+    }
+}
+
+} // namespace
+
+namespace fake_memcached {
+
+bool start(int base_port, int count) {
+    stop();
+    std::unique_ptr<Server> srv(new Server());
+    for (int port = base_port; port < base_port + count; ++port) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(fd, 64) != 0) {
+            if (fd >= 0) close(fd);
+            for (const auto& l : srv->listeners) close(l.first);
+            return false;
+        }
+        srv->listeners.emplace_back(fd, port);
+    }
+    Server* raw = srv.get();
+    srv->acceptor = std::thread(accept_loop, raw);
+    g_server = std::move(srv);
+    return true;
+}
+
+void stop() {
+    if (!g_server) return;
+    g_server->stopping = true;
+    g_server->acceptor.join();
+    for (const auto& l : g_server->listeners) close(l.first);
+    {
+        std::lock_guard<std::mutex> lock(g_server->mtx);
+        for (int fd : g_server->conns) shutdown(fd, SHUT_RDWR);
+    }
+    for (std::thread& t : g_server->workers) t.join();
+    for (int fd : g_server->conns) close(fd);
+    g_server.reset();
+}
+
+} // namespace fake_memcached
+
+// ---------------------------------------------------------
+// libmemcached subset used by MemcachedClient
+// memcached_st / memcached_result_st are only handed back to this file, so
+// they stand for the Handle / Result objects below
+// ---------------------------------------------------------
+namespace {
+
+struct Handle {
+    std::string server;
+    bool buffered = false;
+    bool noreply = false;
+    bool flush_failed = false;            // NOREPLY: transport error seen on flush
+    std::vector<std::string> mget_keys;
+    size_t mget_pos = 0;
+};
+
+struct Result {
+    std::string key;
+    std::string value;
+};
+
+Handle* handle(memcached_st* m) { return reinterpret_cast<Handle*>(m); }
+memcached_st* token(Handle* h) { return reinterpret_cast<memcached_st*>(h); }
+
+} // namespace
+
+struct memcached_pool_st {
+    Handle* master;
+    int max;
+    int created = 0;
+    std::vector<Handle*> idle;
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+
+extern "C" {
+
+memcached_st* memcached_create(memcached_st*) {
+    return token(new Handle());
+}
+
+void memcached_free(memcached_st* m) {
+    delete handle(m);
+}
+
+memcached_return_t memcached_server_add(memcached_st* m, const char* hostname, in_port_t port) {
+    handle(m)->server = std::string(hostname) + ":" + std::to_string(port);
+    return MEMCACHED_SUCCESS;
+}
+
+memcached_return_t memcached_behavior_set(memcached_st* m, memcached_behavior_t flag, uint64_t data) {
+    if (flag == MEMCACHED_BEHAVIOR_BUFFER_REQUESTS) handle(m)->buffered = data != 0;
+    if (flag == MEMCACHED_BEHAVIOR_NOREPLY) handle(m)->noreply = data != 0;
+    return MEMCACHED_SUCCESS;
+}
+
+const char* memcached_strerror(const memcached_st*, memcached_return_t rc) {
+    switch (rc) {
+        case MEMCACHED_SUCCESS: return "SUCCESS";
+        case MEMCACHED_NOTFOUND: return "NOT FOUND";
+        case MEMCACHED_BUFFERED: return "ACTION QUEUED";
+        case MEMCACHED_CONNECTION_FAILURE: return "CONNECTION FAILURE";
+        case MEMCACHED_E2BIG: return "ITEM TOO BIG";
+        default: return "FAILURE";
+    }
+}
+
+memcached_return_t memcached_set(memcached_st* m, const char* key, size_t key_length,
+                                 const char* value, size_t value_length, time_t, uint32_t) {
+    Handle* h = handle(m);
+    if (!h->buffered) delay();
+    memcached_return_t rc = store_value(h->server, std::string(key, key_length), value, value_length);
+    if (h->noreply) {
+        // the server's answer never comes back; only a dead connection is noticed
+        if (rc == MEMCACHED_CONNECTION_FAILURE) h->flush_failed = true;
+        return h->buffered ? MEMCACHED_BUFFERED : MEMCACHED_SUCCESS;
+    }
+    return rc;
+}
+
+memcached_return_t memcached_flush_buffers(memcached_st* m) {
+    Handle* h = handle(m);
+    delay();
+    bool failed = h->flush_failed;
+    h->flush_failed = false;
+    return failed ? MEMCACHED_CONNECTION_FAILURE : MEMCACHED_SUCCESS;
+}
+
+char* memcached_get(memcached_st* m, const char* key, size_t key_length,
+                    size_t* value_length, uint32_t* flags, memcached_return_t* error) {
+    Handle* h = handle(m);
+    delay();
+    if (is_down(h->server)) {
+        *error = MEMCACHED_CONNECTION_FAILURE;
+        return nullptr;
+    }
+    std::string value;
+    if (!load_value(h->server, std::string(key, key_length), value)) {
+        *error = MEMCACHED_NOTFOUND;
+        return nullptr;
+    }
+    char* out = static_cast<char*>(malloc(value.size() + 1));
+    memcpy(out, value.data(), value.size());
+    out[value.size()] = '\0';
+    *value_length = value.size();
+    if (flags) *flags = 0;
+    *error = MEMCACHED_SUCCESS;
+    return out;
+}
+
+memcached_return_t memcached_mget(memcached_st* m, const char* const* keys,
+                                  const size_t* key_length, size_t number_of_keys) {
+    Handle* h = handle(m);
+    delay();
+    h->mget_keys.clear();
+    h->mget_pos = 0;
+    if (is_down(h->server)) return MEMCACHED_CONNECTION_FAILURE;
+    for (size_t i = 0; i < number_of_keys; ++i) h->mget_keys.emplace_back(keys[i], key_length[i]);
+    return MEMCACHED_SUCCESS;
+}
+
+// MemcachedClient always passes result == NULL and frees what it gets back
+memcached_result_st* memcached_fetch_result(memcached_st* m, memcached_result_st*,
+                                            memcached_return_t* error) {
+    Handle* h = handle(m);
+    while (h->mget_pos < h->mget_keys.size()) {
+        const std::string& key = h->mget_keys[h->mget_pos++];
+        std::string value;
+        if (!load_value(h->server, key, value)) continue;
+        Result* r = new Result();
+        r->key = key;
+        r->value = std::move(value);
+        *error = MEMCACHED_SUCCESS;
+        return reinterpret_cast<memcached_result_st*>(r);
+    }
+    *error = MEMCACHED_END;
+    return nullptr;
+}
+
+const char* memcached_result_key_value(const memcached_result_st* r) {
+    return reinterpret_cast<const Result*>(r)->key.data();
+}
+
+size_t memcached_result_key_length(const memcached_result_st* r) {
+    return reinterpret_cast<const Result*>(r)->key.size();
+}
+
+const char* memcached_result_value(const memcached_result_st* r) {
+    return reinterpret_cast<const Result*>(r)->value.data();
+}
+
+size_t memcached_result_length(const memcached_result_st* r) {
+    return reinterpret_cast<const Result*>(r)->value.size();
+}
+
+void memcached_result_free(memcached_result_st* r) {
+    delete reinterpret_cast<Result*>(r);
+}
+
+memcached_pool_st* memcached_pool_create(memcached_st* mmc, int, int max) {
+    memcached_pool_st* pool = new memcached_pool_st();
+    pool->master = handle(mmc);
+    pool->max = max;
+    return pool;
+}
+
+memcached_st* memcached_pool_destroy(memcached_pool_st* pool) {
+    for (Handle* h : pool->idle) delete h;
+    memcached_st* master = token(pool->master);
+    delete pool;
+    return master;
+}
+
+memcached_st* memcached_pool_fetch(memcached_pool_st* pool, struct timespec* relative_time,
+                                   memcached_return_t* rc) {
+    std::unique_lock<std::mutex> lock(pool->mtx);
+    auto timeout = std::chrono::seconds(relative_time ? relative_time->tv_sec : 5);
+    if (!pool->cv.wait_for(lock, timeout, [pool] {
+            return !pool->idle.empty() || pool->created < pool->max;
+        })) {
+        *rc = MEMCACHED_FAILURE;
+        return nullptr;
+    }
+    Handle* h;
+    if (!pool->idle.empty()) {
+        h = pool->idle.back();
+        pool->idle.pop_back();
+    } else {
+        h = new Handle(*pool->master);
+        pool->created++;
+    }
+    *rc = MEMCACHED_SUCCESS;
+    return token(h);
+}
+
+memcached_return_t memcached_pool_release(memcached_pool_st* pool, memcached_st* m) {
+    {
+        std::lock_guard<std::mutex> lock(pool->mtx);
+        pool->idle.push_back(handle(m));
+    }
+    pool->cv.notify_one();
+    return MEMCACHED_SUCCESS;
+}
+
+} // extern "C"
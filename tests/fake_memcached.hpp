@@ -0,0 +1,46 @@
+// fake_memcached.hpp
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+
+// In-process stand-in for the memcached servers, linked into the tests in
+// place of libmemcached. It implements the libmemcached calls MemcachedClient
+// makes (set / get / mget / pools) over an in-memory store, and serves the
+// binary protocol (GET / SET) for MemcachedAsyncEngine on 127.0.0.1 from the
+// same store. A server is "ip:port": the libmemcached side uses the address
+// given to memcached_server_add, the binary side "127.0.0.1:<port>".
+//
+// Handles with MEMCACHED_BEHAVIOR_NOREPLY behave like the real thing: a SET
+// the server rejects is dropped without an error reaching the client.
+namespace fake_memcached {
+
+// server -> key -> value
+typedef std::map<std::string, std::map<std::string, std::string>> Snapshot;
+
+// serve the binary protocol on 127.0.0.1:[base_port, base_port + count)
+bool start(int base_port, int count);
+void stop();
+
+void clear();
+Snapshot snapshot();
+void restore(const Snapshot& snap);
+bool get(const std::string& server, const std::string& key, std::string& value);
+bool erase(const std::string& server, const std::string& key);
+
+// requests to a down server fail as if it crashed (connection errors)
+void set_down(const std::string& server, bool down);
+// SETs larger than bytes are rejected like memcached's item size limit; 0 = none
+void set_max_item_size(size_t bytes);
+// delay before answering: once per libmemcached call, once per received
+// burst on a binary connection (one round trip, however many requests)
+void set_latency(std::chrono::microseconds latency);
+
+// requests served so far (both sides)
+size_t get_count();
+size_t set_count();
+// GETs served on the binary protocol (MemcachedAsyncEngine, get_into)
+size_t binary_get_count();
+
+} // namespace fake_memcached
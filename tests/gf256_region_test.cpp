@@ -0,0 +1,92 @@
+// gf256_region_test.cpp
+// 区域内核与逐字节 gf256_mul 一致：对每个系数 0..255、若干长度（含不足一个
+// 向量的尾部）和非对齐的 src / dst 偏移，检查 mul / mul_xor 及其 _tbl 版本，
+// 以及 dst 区间外的字节不被改写。
+// 实现按 GF256_REGION_BACKEND 选择（ctest 对每个后端各跑一次）；
+// CPU 不支持强制的后端时返回 kSkip
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "gf256_region.hpp"
+#include "gf256_solver.hpp"
+#include "test_common.hpp"
+
+namespace {
+
+const int kSkip = 77;
+const size_t kGuard = 64;   // dst 前后的保护区
+
+void fill(std::vector<uint8_t>& buf, std::mt19937& rng) {
+    for (auto& b : buf) b = (uint8_t)(rng() & 0xff);
+}
+
+} // namespace
+
+int main() {
+    init_tables();
+    const char* forced = std::getenv("GF256_REGION_BACKEND");
+    if (forced && std::strcmp(forced, gf256_region_backend()) != 0) {
+        std::cout << "gf256_region_test: backend " << forced << " not supported, skipped" << std::endl;
+        return kSkip;
+    }
+
+    std::mt19937 rng(19);
+    int checked = 0;
+    for (size_t len : {size_t(0), size_t(1), size_t(15), size_t(33), size_t(63), size_t(4097)}) {
+        for (size_t src_off : {size_t(0), size_t(1), size_t(7)}) {
+            for (size_t dst_off : {size_t(0), size_t(3)}) {
+                std::vector<uint8_t> src(src_off + len);
+                std::vector<uint8_t> dst(kGuard + dst_off + len + kGuard);
+                for (int coef = 0; coef < 256; ++coef) {
+                    fill(src, rng);
+                    const uint8_t* s = src.data() + src_off;
+                    gf256_nibble_table t;
+                    gf256_build_nibble_table((uint8_t)coef, t);
+
+                    for (int variant = 0; variant < 4; ++variant) {
+                        const bool xor_into = variant & 1;
+                        const bool with_table = variant & 2;
+                        fill(dst, rng);
+                        const std::vector<uint8_t> before = dst;
+                        uint8_t* d = dst.data() + kGuard + dst_off;
+
+                        if (with_table) {
+                            if (xor_into) gf256_region_mul_xor_tbl(d, s, t, len);
+                            else gf256_region_mul_tbl(d, s, t, len);
+                        } else {
+                            if (xor_into) gf256_region_mul_xor(d, s, (uint8_t)coef, len);
+                            else gf256_region_mul(d, s, (uint8_t)coef, len);
+                        }
+
+                        for (size_t i = 0; i < dst.size(); ++i) {
+                            const size_t begin = kGuard + dst_off;
+                            uint8_t expected = before[i];
+                            if (i >= begin && i < begin + len) {
+                                uint8_t v = gf256_mul((uint8_t)coef, s[i - begin]);
+                                expected = xor_into ? (uint8_t)(expected ^ v) : v;
+                            }
+                            if (dst[i] != expected) {
+                                std::cerr << gf256_region_backend() << ": coef " << coef << " len " << len
+                                          << " src+" << src_off << " dst+" << dst_off << " variant "
+                                          << variant << " byte " << i << std::endl;
+                            }
+                            CHECK(dst[i] == expected);
+                        }
+                        ++checked;
+                    }
+
+                    // 原地乘（dst == src）
+                    std::vector<uint8_t> inplace(src);
+                    gf256_region_mul(inplace.data() + src_off, inplace.data() + src_off, (uint8_t)coef, len);
+                    for (size_t i = 0; i < len; ++i)
+                        CHECK(inplace[src_off + i] == gf256_mul((uint8_t)coef, s[i]));
+                }
+            }
+        }
+    }
+    std::cout << "gf256_region_test: " << gf256_region_backend() << ", " << checked << " cases" << std::endl;
+    return 0;
+}
@@ -0,0 +1,41 @@
+// placement_test.cpp
+// group_by_server 按实际地址分组：每个 (ip, port) 恰好一个 batch，
+// 单机部署时不同 rack 的同号 server 合并为一个 batch
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "placement.hpp"
+#include "test_common.hpp"
+
+int main() {
+    const int k1 = 4, m1 = 2, k2 = 3, m2 = 2;
+    const int kRacks = 40, kServersPerRack = 3;
+    const int total = (k1 + m1) * (k2 + m2);
+
+    for (int strategy = 1; strategy <= 7; ++strategy) {
+        Placement pl(k1, m1, k2, m2, strategy, kRacks, kServersPerRack, test::kBasePort);
+        pl.init();
+        pl.generate_mapping();
+        std::vector<int> ids;
+        for (int id = 0; id < total; ++id) ids.push_back(id);
+
+        std::vector<ServerBatch> batches = pl.group_by_server(ids);
+        std::set<std::pair<std::string, int>> servers, expected;
+        size_t grouped = 0;
+        for (const ServerBatch& batch : batches) {
+            CHECK(servers.insert(std::make_pair(batch.ip, batch.port)).second);
+            for (int id : batch.block_ids) {
+                const PlacementEntry& e = pl.get(id);
+                CHECK(pl.server_ip(e) == batch.ip && pl.server_port(e) == batch.port);
+            }
+            grouped += batch.block_ids.size();
+        }
+        for (int id : ids) expected.insert(std::make_pair(pl.server_ip(pl.get(id)), pl.server_port(pl.get(id))));
+        CHECK(grouped == ids.size());
+        CHECK(servers == expected);
+        CHECK((int)batches.size() <= kServersPerRack);   // 所有 rack 都是 127.0.0.1
+    }
+    std::cout << "placement_test: ok" << std::endl;
+    return 0;
+}
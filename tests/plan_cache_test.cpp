@@ -0,0 +1,66 @@
+// plan_cache_test.cpp
+// 规划缓存按行 / 列置换和机架重标号复用计划：在轮转后的放置上对随机坏块集合
+// 分别打开 / 关闭缓存规划（EXACT），两者可修复性一致、总代价相等。
+// calculate_cost 若引入了规范化模式之外的因素（具体机架号、server 等），这里会失败
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "placement.hpp"
+#include "repair.hpp"
+#include "test_common.hpp"
+
+namespace {
+
+const int k1 = 4, m1 = 2, k2 = 3, m2 = 2;
+const int kRacks = 40, kServersPerRack = 3;
+const int kStripes = 8;
+const int kTrials = 25;
+
+} // namespace
+
+int main() {
+    const int total = (k1 + m1) * (k2 + m2);
+    std::mt19937 rng(13);
+
+    int compared = 0, feasible = 0;
+    for (int strategy = 1; strategy <= 7; ++strategy) {
+        Placement base(k1, m1, k2, m2, strategy, kRacks, kServersPerRack, test::kBasePort);
+        base.init();
+        base.generate_mapping();
+
+        for (RepairMode mode : {RepairMode::CENTRAL, RepairMode::PIPELINED, RepairMode::RACK_LOCAL}) {
+            Repair cached(k1, m1, k2, m2), uncached(k1, m1, k2, m2);
+            for (Repair* repair : {&cached, &uncached}) {
+                repair->set_strategy(strategy);
+                repair->set_repair_mode(mode);
+                repair->set_planner(RepairPlanner::EXACT);
+            }
+            uncached.set_plan_cache(false);
+
+            for (int s = 0; s < kStripes; ++s) {
+                Placement pl = base.rotated((uint64_t)s, "obj:" + std::to_string(s) + ":");
+                for (int t = 0; t < kTrials; ++t) {
+                    auto failed = test::random_failures(1 + (int)(rng() % 12), total, rng);
+                    StripeRepairJob with_cache, without_cache;
+                    bool ok = cached.prepare_stripe_repair(failed, pl, with_cache);
+                    CHECK(ok == uncached.prepare_stripe_repair(failed, pl, without_cache));
+                    ++compared;
+                    if (!ok) continue;
+                    if (with_cache.plan_cost != without_cache.plan_cost) {
+                        std::cerr << "strategy " << strategy << " stripe " << s << ": cost "
+                                  << with_cache.plan_cost << " with cache, "
+                                  << without_cache.plan_cost << " without" << std::endl;
+                    }
+                    CHECK(with_cache.plan_cost == without_cache.plan_cost);
+                    ++feasible;
+                }
+            }
+            CHECK(cached.plan_cache_stats().hits > 0);
+        }
+    }
+    CHECK(feasible > 0);
+    std::cout << "plan_cache_test: " << compared << " failure sets, " << feasible
+              << " repairable" << std::endl;
+    return 0;
+}
@@ -0,0 +1,91 @@
+// planner_test.cpp
+// 精确规划与贪心剥离的对比（compare_planners）：随机坏块集合上，
+// 精确规划有解时贪心也有解，且精确代价不超过贪心代价；
+// 坏块数超过 kExactPlannerLimit 时 EXACT 退回贪心，不再枚举 2^n 个掩码
+#include <iostream>
+#include <random>
+
+#include "placement.hpp"
+#include "repair.hpp"
+#include "test_common.hpp"
+
+namespace {
+
+const int kRacks = 40, kServersPerRack = 3;
+const int kTrials = 200;
+
+// 整行 rows 和整列 cols 全部丢失：其余行各丢 cols.size() 块可解，之后这些列可解
+std::unordered_set<int> lost_lines(int k1, int m1, int k2, int m2, int rows, int cols) {
+    std::unordered_set<int> failed;
+    const int width = k1 + m1, height = k2 + m2;
+    for (int r = 0; r < height; ++r)
+        for (int c = 0; c < width; ++c)
+            if (r >= height - rows || c >= width - cols) failed.insert(r * width + c);
+    return failed;
+}
+
+} // namespace
+
+int main() {
+    const int k1 = 4, m1 = 2, k2 = 3, m2 = 2;
+    const int total = (k1 + m1) * (k2 + m2);
+    std::mt19937 rng(11);
+
+    long long exact_sum = 0, greedy_sum = 0;
+    int compared = 0, worse = 0;
+    double exact_ms = 0, greedy_ms = 0;
+    for (int strategy = 1; strategy <= 7; ++strategy) {
+        Placement pl(k1, m1, k2, m2, strategy, kRacks, kServersPerRack, test::kBasePort);
+        pl.init();
+        pl.generate_mapping();
+        Repair repair(k1, m1, k2, m2);
+        repair.set_strategy(strategy);
+
+        for (int t = 0; t < kTrials; ++t) {
+            auto failed = test::random_failures(1 + (int)(rng() % 10), total, rng);
+            RepairPlanComparison cmp = repair.compare_planners(failed, pl);
+            if (cmp.exact_cost < 0) continue;   // 不可修复
+            CHECK(cmp.greedy_cost >= 0);
+            CHECK(cmp.exact_cost <= cmp.greedy_cost);
+            exact_sum += cmp.exact_cost;
+            greedy_sum += cmp.greedy_cost;
+            exact_ms += cmp.exact_ms;
+            greedy_ms += cmp.greedy_ms;
+            worse += cmp.greedy_cost > cmp.exact_cost;
+            ++compared;
+        }
+    }
+    CHECK(compared > 0);
+    std::cout << "planner_test: " << compared << " failure sets, exact cost " << exact_sum
+              << " (" << exact_ms << " ms), greedy cost " << greedy_sum << " (" << greedy_ms
+              << " ms), greedy worse on " << worse << std::endl;
+
+    // 超过 kExactPlannerLimit 的坏块集合：EXACT 与 GREEDY 给出同一个计划
+    const int K1 = 10, M1 = 2, K2 = 10, M2 = 2;
+    Placement big(K1, M1, K2, M2, 3, kRacks, kServersPerRack, test::kBasePort);
+    big.init();
+    big.generate_mapping();
+    for (int lines : {1, 2}) {
+        std::unordered_set<int> failed = lost_lines(K1, M1, K2, M2, lines, lines);
+        CHECK((int)failed.size() > Repair::kExactPlannerLimit);
+
+        int cost[2] = {-1, -1};
+        RepairPlanner planners[2] = {RepairPlanner::EXACT, RepairPlanner::GREEDY};
+        for (int i = 0; i < 2; ++i) {
+            Repair repair(K1, M1, K2, M2);
+            repair.set_strategy(3);
+            repair.set_planner(planners[i]);
+            repair.set_plan_cache(false);
+            StripeRepairJob job;
+            CHECK(repair.prepare_stripe_repair(failed, big, job));
+            cost[i] = job.plan_cost;
+        }
+        CHECK(cost[0] == cost[1]);
+
+        Repair repair(K1, M1, K2, M2);
+        repair.set_strategy(3);
+        RepairPlanComparison cmp = repair.compare_planners(failed, big);
+        CHECK(cmp.exact_cost == -1 && cmp.greedy_cost == cost[1]);
+    }
+    return 0;
+}
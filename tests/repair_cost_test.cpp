@@ -0,0 +1,156 @@
+// repair_cost_test.cpp
+// 规划代价与实际跨机架流量一致：对每种修复方式、每种放置策略，
+// 随机坏块修复后 cross_rack_bytes == (plan_cost + 写回分发) x 块大小。
+// 写回分发：每步修好的块在目标机架（step_needed[0] 所在机架）算出，
+// 其余丢失块再发往各自机架，这部分不计入规划代价。
+// 零拷贝读取失败退回 mget、或写回失败时，读取量不重复计数（单步与多步计划）
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+#include "encoder.hpp"
+#include "gf256_solver.hpp"
+#include "memcached_client.hpp"
+#include "placement.hpp"
+#include "repair.hpp"
+#include "test_common.hpp"
+
+namespace {
+
+const int k1 = 4, m1 = 2, k2 = 3, m2 = 2;
+const int kBlockSize = 4096;
+const int kRacks = 40, kServersPerRack = 3;
+const int kTrials = 20;
+
+int dispersal(const StripeRepairJob& job, const Placement& pl) {
+    int blocks = 0;
+    for (const auto& needed : job.step_needed) {
+        if (needed.empty()) continue;
+        int target_rack = pl.get(needed[0]).rack;
+        for (int bid : needed) blocks += pl.get(bid).rack != target_rack;
+    }
+    return blocks;
+}
+
+const char* mode_name(RepairMode mode) {
+    switch (mode) {
+    case RepairMode::CENTRAL: return "central";
+    case RepairMode::PIPELINED: return "pipelined";
+    default: return "rack_local";
+    }
+}
+
+} // namespace
+
+int main() {
+    init_tables();
+    CHECK(fake_memcached::start(test::kBasePort, kServersPerRack));
+
+    const int total = (k1 + m1) * (k2 + m2);
+    std::mt19937 rng(7);
+    Encoder encoder;
+    auto encoded = encoder.encode(test::random_blocks(k1 * k2, kBlockSize, rng), k1, m1, k2, m2, kBlockSize);
+
+    MemcachedClient client;
+    int checked = 0;
+    for (int strategy = 1; strategy <= 7; ++strategy) {
+        Placement pl(k1, m1, k2, m2, strategy, kRacks, kServersPerRack, test::kBasePort);
+        pl.init();
+        pl.generate_mapping();
+        fake_memcached::clear();
+        CHECK(pl.write_all_blocks(encoded, client) == total);
+        const fake_memcached::Snapshot stored = fake_memcached::snapshot();
+
+        for (RepairMode mode : {RepairMode::CENTRAL, RepairMode::PIPELINED, RepairMode::RACK_LOCAL}) {
+            for (size_t block_size : {size_t(0), size_t(kBlockSize)}) {
+                Repair repair(k1, m1, k2, m2);
+                repair.set_strategy(strategy);
+                repair.set_repair_mode(mode);
+                repair.set_block_size(block_size);
+
+                int repaired = 0;
+                for (int t = 0; t < kTrials; ++t) {
+                    auto failed = test::random_failures(1 + (int)(rng() % 5), total, rng);
+                    StripeRepairJob job;
+                    if (!repair.prepare_stripe_repair(failed, pl, job)) continue;   // 不可修复
+
+                    test::erase_blocks(pl, failed);
+                    repair.reset_traffic_stats();
+                    const size_t mgets = fake_memcached::get_count() - fake_memcached::binary_get_count();
+                    double ms = 0;
+                    CHECK(repair.repair_and_set(failed, pl, client, ms));
+                    // 块大小已知时集中式修复（含多步计划）只经 get_into 读取，不走 mget
+                    if (mode == RepairMode::CENTRAL && block_size > 0)
+                        CHECK(fake_memcached::get_count() - fake_memcached::binary_get_count() == mgets);
+                    for (int id : failed) CHECK(test::block_equals(pl, id, encoded.at(id)));
+
+                    uint64_t expected = (uint64_t)(job.plan_cost + dispersal(job, pl)) * kBlockSize;
+                    uint64_t actual = repair.traffic_stats().cross_rack_bytes;
+                    if (actual != expected) {
+                        std::cerr << mode_name(mode) << " strategy " << strategy << " block_size "
+                                  << block_size << ": cross_rack_bytes " << actual << ", planned "
+                                  << expected << std::endl;
+                    }
+                    CHECK(actual == expected);
+                    fake_memcached::restore(stored);
+                    ++repaired;
+                }
+                checked += repaired;
+                // 集中式修复从首次 mget 记下块大小，之后走零拷贝路径
+                if (mode == RepairMode::CENTRAL && repaired > 0) CHECK(repair.block_size() == kBlockSize);
+            }
+        }
+    }
+    CHECK(checked > 0);
+    std::cout << "repair_cost_test: " << checked << " repairs checked" << std::endl;
+
+    // 单步集中式修复（行 0 丢两块），块大小已知
+    Placement pl(k1, m1, k2, m2, 3, kRacks, kServersPerRack, test::kBasePort);
+    pl.init();
+    pl.generate_mapping();
+    fake_memcached::clear();
+    CHECK(pl.write_all_blocks(encoded, client) == total);
+    const fake_memcached::Snapshot stored = fake_memcached::snapshot();
+    const std::unordered_set<int> row_lost = {0, 1};
+    Repair repair(k1, m1, k2, m2);
+    repair.set_strategy(3);
+    repair.set_block_size(kBlockSize);
+    StripeRepairJob job;
+    CHECK(repair.prepare_stripe_repair(row_lost, pl, job) && job.plan.size() == 1);
+    double ms = 0;
+
+    // 写回被拒绝：直接失败，不再经 mget 重读一遍
+    test::erase_blocks(pl, row_lost);
+    repair.reset_traffic_stats();
+    size_t mgets = fake_memcached::get_count() - fake_memcached::binary_get_count();
+    fake_memcached::set_max_item_size(kBlockSize / 2);
+    CHECK(!repair.repair_and_set(row_lost, pl, client, ms));
+    fake_memcached::set_max_item_size(0);
+    CHECK(repair.traffic_stats().blocks_read == (uint64_t)k1);
+    CHECK(fake_memcached::get_count() - fake_memcached::binary_get_count() == mgets);
+
+    // 选中的一个幸存块丢失：零拷贝读取失败，退回 mget 也只读到其余 k1 - 1 块，各计一次
+    fake_memcached::restore(stored);
+    test::erase_blocks(pl, row_lost);
+    test::erase_blocks(pl, {job.step_survivors[0].back()});
+    repair.reset_traffic_stats();
+    CHECK(!repair.repair_and_set(row_lost, pl, client, ms));
+    CHECK(repair.traffic_stats().blocks_read == (uint64_t)(k1 - 1));
+    CHECK(repair.traffic_stats().bytes_read == (uint64_t)(k1 - 1) * kBlockSize);
+
+    // 多步计划（两步互不依赖，同时启动）：第一步的一个幸存块丢失，
+    // 该步退回 mget 只计一次读取，第二步照常完成
+    fake_memcached::restore(stored);
+    const std::unordered_set<int> two_lost = {0, 7};
+    CHECK(repair.prepare_stripe_repair(two_lost, pl, job) && job.plan.size() == 2);
+    CHECK(job.plan[0].deps.empty() && job.plan[1].deps.empty());
+    test::erase_blocks(pl, two_lost);
+    test::erase_blocks(pl, {job.step_survivors[0].back()});
+    repair.reset_traffic_stats();
+    CHECK(!repair.repair_and_set(two_lost, pl, client, ms));
+    const uint64_t expect = job.step_survivors[0].size() - 1 + job.step_survivors[1].size();
+    CHECK(repair.traffic_stats().blocks_read == expect);
+    CHECK(repair.traffic_stats().bytes_read == expect * kBlockSize);
+    fake_memcached::stop();
+    return 0;
+}
@@ -0,0 +1,82 @@
+// repair_plan_test.cpp
+// 多步修复计划按依赖并发执行（parallel_actions > 1）：
+// 行 0 和列 0 各丢 3 块（超过 m1 / m2），计划至少三步，后面的步骤用前面修好的块。
+// 各修复方式都能恢复原值；被依赖的一步读不到幸存块而失败时，repair_and_set
+// 返回 false 而不是挂起，之后同一 Repair 仍能完成修复（produced 等执行状态不残留）
+#include <iostream>
+#include <random>
+
+#include "encoder.hpp"
+#include "gf256_solver.hpp"
+#include "memcached_client.hpp"
+#include "placement.hpp"
+#include "repair.hpp"
+#include "test_common.hpp"
+
+namespace {
+
+const int k1 = 4, m1 = 2, k2 = 3, m2 = 2;
+const int kBlockSize = 4096;
+const int kRacks = 40, kServersPerRack = 3;
+
+int block_id(int r, int c) { return r * (k1 + m1) + c; }
+
+} // namespace
+
+int main() {
+    init_tables();
+    CHECK(fake_memcached::start(test::kBasePort, kServersPerRack));
+    fake_memcached::set_latency(std::chrono::microseconds(200));
+
+    std::mt19937 rng(17);
+    Encoder encoder;
+    auto encoded = encoder.encode(test::random_blocks(k1 * k2, kBlockSize, rng), k1, m1, k2, m2, kBlockSize);
+
+    MemcachedClient client;
+    Placement pl(k1, m1, k2, m2, 3, kRacks, kServersPerRack, test::kBasePort);
+    pl.init();
+    pl.generate_mapping();
+    CHECK(pl.write_all_blocks(encoded, client) == (k1 + m1) * (k2 + m2));
+    const fake_memcached::Snapshot stored = fake_memcached::snapshot();
+
+    const std::unordered_set<int> failed = {block_id(0, 0), block_id(0, 1), block_id(0, 2),
+                                            block_id(1, 0), block_id(2, 0)};
+
+    struct Config { RepairMode mode; size_t block_size; };
+    for (const Config& config : {Config{RepairMode::CENTRAL, 0}, Config{RepairMode::CENTRAL, kBlockSize},
+                                 Config{RepairMode::PIPELINED, 0}, Config{RepairMode::RACK_LOCAL, 0}}) {
+        for (int parallel : {1, 4}) {
+            Repair repair(k1, m1, k2, m2);
+            repair.set_strategy(3);
+            repair.set_repair_mode(config.mode);
+            repair.set_block_size(config.block_size);
+            repair.set_parallel_actions(parallel);
+
+            StripeRepairJob job;
+            CHECK(repair.prepare_stripe_repair(failed, pl, job));
+            int dep = -1;   // 被其它步骤依赖的一步
+            for (const RepairAction& action : job.plan)
+                if (!action.deps.empty()) dep = action.deps[0];
+            CHECK(job.plan.size() >= 3 && dep >= 0);
+
+            // 删掉这一步选中的一个完好幸存块：它失败，依赖它的步骤不能执行
+            int victim = -1;
+            for (int bid : job.step_survivors[dep])
+                if (!failed.count(bid)) victim = bid;
+            CHECK(victim >= 0);
+            double ms = 0;
+            test::erase_blocks(pl, failed);
+            test::erase_blocks(pl, {victim});
+            CHECK(!repair.repair_and_set(failed, pl, client, ms));
+
+            fake_memcached::restore(stored);
+            test::erase_blocks(pl, failed);
+            CHECK(repair.repair_and_set(failed, pl, client, ms));
+            for (int id : failed) CHECK(test::block_equals(pl, id, encoded.at(id)));
+        }
+    }
+
+    std::cout << "repair_plan_test: ok" << std::endl;
+    fake_memcached::stop();
+    return 0;
+}
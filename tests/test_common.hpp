@@ -0,0 +1,58 @@
+// test_common.hpp
+#pragma once
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "fake_memcached.hpp"
+#include "placement.hpp"
+
+// 失败时打印位置并退出（ctest 以非零退出码判定失败）。用 _Exit：
+// fake server 和 I/O 线程仍在运行，不能执行静态对象的析构
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond \
+                      << std::endl;                                              \
+            std::_Exit(1);                                                       \
+        }                                                                        \
+    } while (0)
+
+namespace test {
+
+// 避开本机可能在跑的 memcached（11211 起）
+const int kBasePort = 29211;
+
+inline std::string server_of(const Placement& pl, int block_id) {
+    const PlacementEntry& e = pl.get(block_id);
+    return pl.server_ip(e) + ":" + std::to_string(pl.server_port(e));
+}
+
+inline void erase_blocks(const Placement& pl, const std::unordered_set<int>& ids,
+                         const std::string& key_suffix = "") {
+    for (int id : ids) fake_memcached::erase(server_of(pl, id), pl.block_key(id) + key_suffix);
+}
+
+inline bool block_equals(const Placement& pl, int id, const std::string& expected) {
+    std::string value;
+    return fake_memcached::get(server_of(pl, id), pl.block_key(id), value) && value == expected;
+}
+
+inline std::vector<std::string> random_blocks(int n, size_t size, std::mt19937& rng) {
+    std::vector<std::string> blocks(n, std::string(size, '\0'));
+    for (auto& b : blocks)
+        for (auto& c : b) c = (char)(rng() & 0xff);
+    return blocks;
+}
+
+inline std::unordered_set<int> random_failures(int n, int total, std::mt19937& rng) {
+    std::unordered_set<int> failed;
+    while ((int)failed.size() < n) failed.insert((int)(rng() % total));
+    return failed;
+}
+
+} // namespace test
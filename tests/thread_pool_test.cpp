@@ -0,0 +1,95 @@
+// thread_pool_test.cpp
+// 工作窃取线程池：
+//   - 嵌套 fork/join：任务里再建 TaskGroup 派生子任务并 wait，线程数少于
+//     同时等待的任务数（含单线程池）也不会死锁；
+//   - 窃取：一个 worker 派生的任务都在它自己的队列里，其它 worker 偷走执行；
+//   - 异常：TaskGroup::wait 重新抛出任务中的第一个异常；
+//   - 关闭：析构前已提交的任务全部执行完
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "thread_pool.hpp"
+#include "test_common.hpp"
+
+namespace {
+
+// 深度 depth、每层 fanout 个子任务的递归 fork/join，返回叶子数
+void fork_join(ThreadPool& pool, int depth, int fanout, std::atomic<int>& leaves) {
+    if (depth == 0) {
+        leaves++;
+        return;
+    }
+    TaskGroup group(pool);
+    for (int i = 0; i < fanout; ++i)
+        group.run([&pool, depth, fanout, &leaves]() { fork_join(pool, depth - 1, fanout, leaves); });
+    group.wait();
+}
+
+} // namespace
+
+int main() {
+    // 嵌套 fork/join
+    for (int threads : {1, 2, 4}) {
+        ThreadPool pool(threads);
+        std::atomic<int> leaves{0};
+        fork_join(pool, 4, 4, leaves);
+        CHECK(leaves == 256);
+    }
+
+    // 窃取：从 worker 内部派生 64 个耗时任务，全部进入该 worker 的队列
+    {
+        ThreadPool pool(4);
+        std::mutex mtx;
+        std::set<std::thread::id> runners;
+        TaskGroup outer(pool);
+        outer.run([&]() {
+            TaskGroup inner(pool);
+            for (int i = 0; i < 64; ++i) {
+                inner.run([&]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    std::lock_guard<std::mutex> lock(mtx);
+                    runners.insert(std::this_thread::get_id());
+                });
+            }
+            inner.wait();
+        });
+        outer.wait();
+        CHECK(runners.size() > 1);
+    }
+
+    // 异常
+    {
+        ThreadPool pool(2);
+        TaskGroup group(pool);
+        std::atomic<int> ran{0};
+        for (int i = 0; i < 16; ++i) {
+            group.run([i, &ran]() {
+                ran++;
+                if (i == 5) throw std::runtime_error("task 5");
+            });
+        }
+        bool thrown = false;
+        try {
+            group.wait();
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        CHECK(thrown && ran == 16);
+    }
+
+    // 关闭：不等待直接析构
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(3);
+        for (int i = 0; i < 1000; ++i) pool.submit([&done]() { done++; });
+    }
+    CHECK(done == 1000);
+
+    std::cout << "thread_pool_test: ok" << std::endl;
+    return 0;
+}
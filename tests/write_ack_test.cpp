@@ -0,0 +1,109 @@
+// write_ack_test.cpp
+// 写入以服务端确认为准：被 server 拒绝（超过 item 大小上限）或 server 宕机的块
+// 不计为写入成功，修复写回失败时 repair_and_set 返回 false；
+// 分块格式的修复在 chunk 写回失败时不写头
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "chunk_format.hpp"
+#include "chunked_stripe.hpp"
+#include "encoder.hpp"
+#include "gf256_solver.hpp"
+#include "memcached_client.hpp"
+#include "placement.hpp"
+#include "repair.hpp"
+#include "test_common.hpp"
+
+namespace {
+
+const int k1 = 4, m1 = 2, k2 = 3, m2 = 2;
+const int kBlockSize = 4096;
+const int kRacks = 40, kServersPerRack = 3;
+
+} // namespace
+
+int main() {
+    init_tables();
+    CHECK(fake_memcached::start(test::kBasePort, kServersPerRack));
+
+    const int total = (k1 + m1) * (k2 + m2);
+    std::mt19937 rng(11);
+    Encoder encoder;
+    const std::vector<std::string> data = test::random_blocks(k1 * k2, kBlockSize, rng);
+    auto encoded = encoder.encode(data, k1, m1, k2, m2, kBlockSize);
+
+    MemcachedClient client;
+    Placement pl(k1, m1, k2, m2, 1, kRacks, kServersPerRack, test::kBasePort);
+    pl.init();
+    pl.generate_mapping();
+
+    // 1. 全部块超过 item 大小上限：没有一个块算写入成功
+    fake_memcached::set_max_item_size(kBlockSize / 2);
+    CHECK(pl.write_all_blocks(encoded, client) == 0);
+    for (int id = 0; id < total; ++id) CHECK(!test::block_equals(pl, id, encoded.at(id)));
+
+    // 2. 一台 server 宕机：只有其上的块写入失败
+    fake_memcached::set_max_item_size(0);
+    const std::string down = test::server_of(pl, 0);
+    int on_down = 0;
+    for (int id = 0; id < total; ++id) on_down += test::server_of(pl, id) == down;
+    fake_memcached::set_down(down, true);
+    std::vector<BlockView> views(total);
+    for (int id = 0; id < total; ++id)
+        views[id] = BlockView{reinterpret_cast<const uint8_t*>(encoded.at(id).data()), encoded.at(id).size()};
+    std::vector<int> failed;
+    PendingWrite w = pl.write_views_async(views, "", client);
+    CHECK(pl.wait_writes(w, &failed) == total - on_down);
+    CHECK((int)failed.size() == on_down);
+    for (int id : failed) CHECK(test::server_of(pl, id) == down);
+    fake_memcached::set_down(down, false);
+
+    // 3. 修复写回被拒绝：修复报告失败
+    CHECK(pl.write_all_blocks(encoded, client) == total);
+    for (RepairMode mode : {RepairMode::CENTRAL, RepairMode::PIPELINED, RepairMode::RACK_LOCAL}) {
+        Repair repair(k1, m1, k2, m2);
+        repair.set_strategy(1);
+        repair.set_repair_mode(mode);
+        std::unordered_set<int> lost = {0, 7};
+        test::erase_blocks(pl, lost);
+
+        double ms = 0;
+        fake_memcached::set_max_item_size(kBlockSize / 2);
+        CHECK(!repair.repair_and_set(lost, pl, client, ms));
+        fake_memcached::set_max_item_size(0);
+        CHECK(repair.repair_and_set(lost, pl, client, ms));
+        for (int id : lost) CHECK(test::block_equals(pl, id, encoded.at(id)));
+    }
+
+    // 4. 分块格式：chunk 写回被拒绝时修复失败，丢失块的头不会写出
+    fake_memcached::clear();
+    const size_t kChunkSize = kBlockSize / 4;
+    std::vector<BlockView> data_views;
+    for (const std::string& d : data)
+        data_views.push_back(BlockView{reinterpret_cast<const uint8_t*>(d.data()), d.size()});
+    ChunkedStripeWriter writer(encoder, pl, client, kChunkSize);
+    CHECK(writer.write(data_views, k1, m1, k2, m2, kBlockSize) == total);
+
+    Repair chunked(k1, m1, k2, m2);
+    chunked.set_strategy(1);
+    chunked.set_chunked(true);
+    std::unordered_set<int> lost = {0, 7};
+    for (int id : lost) {
+        fake_memcached::erase(test::server_of(pl, id), pl.block_key(id));
+        for (int c = 0; c < (int)(kBlockSize / kChunkSize); ++c)
+            fake_memcached::erase(test::server_of(pl, id), pl.block_key(id) + chunk_suffix(c));
+    }
+    double ms = 0;
+    fake_memcached::set_max_item_size(kChunkSize / 2);   // 头（16 字节）放得下，chunk 放不下
+    CHECK(!chunked.repair_and_set(lost, pl, client, ms));
+    std::string head;
+    for (int id : lost) CHECK(!fake_memcached::get(test::server_of(pl, id), pl.block_key(id), head));
+    fake_memcached::set_max_item_size(0);
+    CHECK(chunked.repair_and_set(lost, pl, client, ms));
+    for (int id : lost) CHECK(fake_memcached::get(test::server_of(pl, id), pl.block_key(id), head));
+
+    std::cout << "write_ack_test: ok" << std::endl;
+    fake_memcached::stop();
+    return 0;
+}